@@ -0,0 +1,730 @@
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/clocks.h"
+#include "inc/ssd1306.h"
+#include "inc/anim.h"
+#include "inc/ui.h"
+#include "inc/event.h"
+#include "inc/wheel.h"
+#include "inc/history.h"
+#include "inc/stats.h"
+#include "inc/link.h"
+#include "inc/trace.h"
+
+// Micro-benchmarks das primitivas gráficas do ssd1306 e das telas do programa.
+//
+// Na placa o tempo vem do SysTick contando ciclos do processador (o Cortex-M0+ não tem DWT) e o
+// display real recebe os quadros. No host o tempo vem do relógio monotônico e o I2C vai para o
+// decodificador do simulador (host/sim.c). Cada resultado é uma linha JSON na saída padrão:
+//
+//   {"bench":"rect_fill","platform":"rp2040","driver":"static","calls":...,"ns_per_call":...,"pixels_per_s":...}
+//
+// As cenas acrescentam "bytes_per_flush" e "flush_us" (tempo de barramento, virtual no host). O campo
+// "driver" diz se o driver do display foi especializado na compilação ("static") ou não ("runtime").
+
+#define I2C_PORT SSD1306_I2C
+#define I2C_SDA 14
+#define I2C_SCL 15
+#define endereco SSD1306_ADDRESS
+
+// pomodoro_bench usa o driver do firmware; pomodoro_bench_runtime, o parametrizado em tempo de execução
+#define BENCH_DRIVER (SSD1306_STATIC ? "static" : "runtime")
+
+#if PICO_ON_DEVICE
+#include "pico/stdio_usb.h"
+#include "hardware/structs/systick.h"
+
+#define BENCH_PLATFORM "rp2040"
+#define BENCH_TICK_MASK 0x00FFFFFFu  // SysTick tem 24 bits
+
+static void bench_clock_init(void) {
+  systick_hw->csr = 0;
+  systick_hw->rvr = BENCH_TICK_MASK;
+  systick_hw->cvr = 0;
+  systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+static inline uint32_t bench_ticks(void) {
+  return systick_hw->cvr;
+}
+
+// O SysTick conta para baixo
+static inline uint32_t bench_elapsed(uint32_t start, uint32_t end) {
+  return (start - end) & BENCH_TICK_MASK;
+}
+
+static double bench_ticks_per_ns(void) {
+  return clock_get_hz(clk_sys) / 1e9;
+}
+#else
+#include <time.h>
+#include "sim.h"
+#include "mock_panel.h"
+#include "hardware/flash.h"
+
+#define BENCH_PLATFORM "host"
+#define BENCH_TICK_MASK 0xFFFFFFFFu
+
+static void bench_clock_init(void) {
+}
+
+static inline uint32_t bench_ticks(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t) ((uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+static inline uint32_t bench_elapsed(uint32_t start, uint32_t end) {
+  return end - start;
+}
+
+static double bench_ticks_per_ns(void) {
+  return 1.0;
+}
+#endif
+
+// Um bloco de chamadas precisa caber com folga em uma volta do contador; o total de cada
+// benchmark é de cerca de 1/4 de volta por bloco, repetido até BENCH_MIN_CHUNKS blocos.
+#define BENCH_CHUNK_TICKS ((BENCH_TICK_MASK >> 2) < (1u << 24) ? (BENCH_TICK_MASK >> 2) : (1u << 24))
+#define BENCH_MIN_CHUNKS 8
+#define BENCH_FLUSH_FRAMES 16
+
+static ssd1306_t ssd;
+
+typedef struct {
+  const char *name;
+  void (*run)(uint32_t i);  // Uma chamada; `i` varia a posição ou o conteúdo a cada repetição
+  uint32_t pixels;          // Pixels escritos por chamada (0 omite pixels_per_s)
+  bool scene;               // Mede também os bytes e o tempo do envio
+} bench_case_t;
+
+// ---------------------------------------------------------------------------
+// Versões pixel a pixel das primitivas, como eram antes das rotinas por página,
+// mantidas apenas como referência de comparação.
+
+static void legacy_fill(ssd1306_t *ssd, bool value) {
+  for (uint8_t y = 0; y < ssd->height; ++y)
+    for (uint8_t x = 0; x < ssd->width; ++x)
+      ssd1306_pixel(ssd, x, y, value);
+}
+
+static void legacy_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+  for (uint8_t x = left; x < left + width; ++x) {
+    ssd1306_pixel(ssd, x, top, value);
+    ssd1306_pixel(ssd, x, top + height - 1, value);
+  }
+  for (uint8_t y = top; y < top + height; ++y) {
+    ssd1306_pixel(ssd, left, y, value);
+    ssd1306_pixel(ssd, left + width - 1, y, value);
+  }
+
+  if (fill) {
+    for (uint8_t x = left + 1; x < left + width - 1; ++x)
+      for (uint8_t y = top + 1; y < top + height - 1; ++y)
+        ssd1306_pixel(ssd, x, y, value);
+  }
+}
+
+static void legacy_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y) {
+  const font_glyph_t *glyph = font_glyph(&font_8x8, c);
+  for (uint8_t i = 0; i < 8; ++i) {
+    uint8_t line = i < glyph->width ? font_8x8.bitmap[glyph->offset + i] : 0;
+    for (uint8_t j = 0; j < 8; ++j)
+      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+  }
+}
+
+// Um comando por transação, com o byte de controle 0x80, como o driver enviava antes das listas.
+static void legacy_command(ssd1306_t *ssd, uint8_t command) {
+  uint8_t buffer[2] = { 0x80, command };
+  ssd1306_wait(ssd);
+  i2c_write_blocking(ssd->i2c_port, ssd->address, buffer, 2, false);
+}
+
+// ---------------------------------------------------------------------------
+// Casos
+
+static const char bench_text[] = "Restam 4 ciclos";
+
+static void run_pixel(uint32_t i) {
+  ssd1306_pixel(&ssd, i & 127, (i >> 7) & 63, i & 1);
+}
+
+static void run_fill(uint32_t i) {
+  ssd1306_fill(&ssd, i & 1);
+}
+
+static void run_fill_legacy(uint32_t i) {
+  legacy_fill(&ssd, i & 1);
+}
+
+static void run_rect(uint32_t i) {
+  ssd1306_rect(&ssd, 3, 3, 124, 60, i & 1, false);
+}
+
+static void run_rect_legacy(uint32_t i) {
+  legacy_rect(&ssd, 3, 3, 124, 60, i & 1, false);
+}
+
+static void run_rect_fill(uint32_t i) {
+  ssd1306_rect(&ssd, 10, 20, 64, 40, i & 1, true);
+}
+
+static void run_rect_fill_legacy(uint32_t i) {
+  legacy_rect(&ssd, 10, 20, 64, 40, i & 1, true);
+}
+
+static void run_line(uint32_t i) {
+  ssd1306_line(&ssd, 0, i & 63, 127, 63 - (i & 63), i & 1);
+}
+
+static void run_hline(uint32_t i) {
+  ssd1306_hline(&ssd, 0, 127, i & 63, i & 1);
+}
+
+static void run_vline(uint32_t i) {
+  ssd1306_vline(&ssd, i & 127, 0, 63, i & 1);
+}
+
+static void run_draw_char(uint32_t i) {
+  ssd1306_draw_char(&ssd, 'A' + i % 26, (i & 7) * 8, 8);
+}
+
+static void run_draw_char_unaligned(uint32_t i) {
+  ssd1306_draw_char(&ssd, 'A' + i % 26, (i & 7) * 8, 11);
+}
+
+static void run_draw_char_legacy(uint32_t i) {
+  legacy_draw_char(&ssd, 'A' + i % 26, (i & 7) * 8, 8);
+}
+
+static void run_draw_string(uint32_t i) {
+  ssd1306_draw_string(&ssd, bench_text, 6, (i & 1) ? 10 : 28);
+}
+
+// Dígito de 16x32 da contagem, alinhado às páginas como na tela do temporizador e deslocado
+static void run_draw_digit(uint32_t i) {
+  ssd1306_draw_glyph(&ssd, &font_digits, '0' + i % 10, (i & 3) * 17 + 6, 16);
+}
+
+static void run_draw_digit_unaligned(uint32_t i) {
+  ssd1306_draw_glyph(&ssd, &font_digits, '0' + i % 10, (i & 3) * 17 + 6, 19);
+}
+
+static void run_draw_clock(uint32_t i) {
+  static const char *const clocks[] = { "25:00", "24:59", "09:41", "00:07" };
+  ssd1306_draw_text(&ssd, &font_digits, clocks[i & 3], 6, 16);
+}
+
+// Fila de eventos: um evento publicado e consumido por chamada, como uma interrupção e o laço principal
+static event_t bench_event_buffer[32];
+static event_ring_t bench_events;
+
+static void run_event_ring(uint32_t i) {
+  event_t event;
+  event_post(&bench_events, EVENT_TICK, 0, i);
+  event_drain(&bench_events, &event, 1);
+}
+
+// Rajada de 8 eventos consumidos em um lote
+static void run_event_batch(uint32_t i) {
+  event_t batch[8];
+  for (uint k = 0; k < count_of(batch); ++k)
+    event_post(&bench_events, EVENT_JOYSTICK, 1, i + k);
+  event_drain(&bench_events, batch, count_of(batch));
+}
+
+// Roda de temporizadores: um tick com N sessões, cada uma reinserida ao fim da fase com durações
+// de 5 a 65 minutos. O custo por tick deve ser o mesmo para 1 ou 1024 sessões.
+static wheel_t bench_wheel;
+static wheel_timer_t bench_timers[1024];
+
+static void bench_timer_expired(wheel_timer_t *timer) {
+  uint32_t phase = 300 + (uint32_t) (timer - bench_timers) * 37 % 3600;
+  wheel_add(&bench_wheel, timer, timer->expires + phase);
+}
+
+static void run_wheel_tick(uint32_t i, uint count) {
+  if (!i) {
+    wheel_init(&bench_wheel, 0);
+    for (uint k = 0; k < count; ++k) {
+      bench_timers[k] = (wheel_timer_t) { .callback = bench_timer_expired };
+      wheel_add(&bench_wheel, &bench_timers[k], 1 + k * 3571 % 3900);
+    }
+  }
+  wheel_advance(&bench_wheel, bench_wheel.now + 1);
+}
+
+static void run_wheel_tick_1(uint32_t i) { run_wheel_tick(i, 1); }
+static void run_wheel_tick_32(uint32_t i) { run_wheel_tick(i, 32); }
+static void run_wheel_tick_1024(uint32_t i) { run_wheel_tick(i, count_of(bench_timers)); }
+
+// Trace: um evento gravado no anel do núcleo, com a leitura do timer e as interrupções mascaradas
+static void run_trace_record(uint32_t i) {
+  trace_record(TRACE_RENDER, TRACE_PH_INSTANT, (uint16_t) i);
+}
+
+// Histórico na flash: um registro por chamada, com as gravações de página e os apagamentos de setor
+// diluídos entre elas. O custo de CPU sai em ns_per_call; o desgaste, na linha history_wear.
+static void run_history_append(uint32_t i) {
+  history_record_t record = {
+    .start_s = i * 60,
+    .preset_cycles = i % 4,
+    .preset_work = i % 6,
+    .preset_break = i % 3,
+    .cycles_done = 2 + i % 4,
+  };
+  history_append(&record);
+  history_service();
+}
+
+// Quanto a flash foi usada pelo caso acima e, no host, como os apagamentos se distribuíram pelos setores
+static void bench_history_report(uint32_t records) {
+  history_stats_t stats;
+  history_get_stats(&stats);
+  printf("{\"bench\":\"history_wear\",\"platform\":\"%s\",\"records\":%lu,\"pages\":%lu,\"erases\":%lu,\"commit_max_us\":%lu",
+         BENCH_PLATFORM, (unsigned long) records, (unsigned long) stats.pages, (unsigned long) stats.erases,
+         (unsigned long) stats.commit_max_us);
+#if !PICO_ON_DEVICE
+  uint32_t first = (PICO_FLASH_SIZE_BYTES / FLASH_SECTOR_SIZE) - HISTORY_SECTORS;
+  uint32_t min = UINT32_MAX, max = 0;
+  for (uint32_t s = first; s < first + HISTORY_SECTORS; ++s) {
+    uint32_t erases = sim_flash_sector_erases(s);
+    if (erases < min) min = erases;
+    if (erases > max) max = erases;
+  }
+  printf(",\"flash_us_per_record\":%.1f,\"sector_erases_min\":%lu,\"sector_erases_max\":%lu",
+         (double) sim_get_stats()->flash_busy_us / records, (unsigned long) min, (unsigned long) max);
+#endif
+  printf("}\n");
+}
+
+#if !PICO_ON_DEVICE
+// Vazão do registro de estatísticas pela porta serial da USB do simulador: quadros binários (inc/link.c)
+// contra o mesmo registro formatado em JSON pelo printf, e a conferência dos quadros capturados. Na
+// placa a USB leva o próprio resultado do benchmark, então o teste só roda no host.
+#define BENCH_STATS_FRAMES 4096
+#define BENCH_STATS_BATCH 32        // Quadros entre leituras da captura do simulador
+
+// Confere os quadros da captura: sincronismo, tipo, comprimento, CRC e números de sequência seguidos
+static uint32_t bench_stats_check(uint32_t *next_seq) {
+  uint8_t bytes[BENCH_STATS_BATCH * (LINK_OVERHEAD + sizeof(stats_t))];
+  size_t len = sim_serial_read(bytes, sizeof(bytes));
+  uint32_t ok = 0;
+  for (size_t at = 0; at + LINK_OVERHEAD + sizeof(stats_t) <= len; at += LINK_OVERHEAD + sizeof(stats_t)) {
+    const uint8_t *frame = &bytes[at];
+    stats_t record;
+    memcpy(&record, &frame[3], sizeof(record));
+    if (frame[0] == LINK_SYNC && frame[1] == LINK_STATS && frame[2] == sizeof(stats_t) &&
+        frame[3 + sizeof(stats_t)] == link_crc(0, &frame[1], 2 + sizeof(stats_t)) && record.seq == *next_seq) {
+      ok++;
+      (*next_seq)++;
+    }
+  }
+  return ok;
+}
+
+static int bench_stats_json(char *out, size_t size, const stats_t *st) {
+  int len = snprintf(out, size, "{\"boot\":%u,\"seq\":%lu,\"uptime_s\":%lu,\"active\":%u,\"focus_s\":%lu,"
+                     "\"cycles_completed\":%lu,\"cycles_aborted\":%lu,\"sessions_completed\":%lu,"
+                     "\"sessions_aborted\":%lu,\"streaks\":[",
+                     st->boot, (unsigned long) st->seq, (unsigned long) st->uptime_s, st->active,
+                     (unsigned long) st->focus_s, (unsigned long) st->cycles_completed,
+                     (unsigned long) st->cycles_aborted, (unsigned long) st->sessions_completed,
+                     (unsigned long) st->sessions_aborted);
+  for (uint i = 0; i < STATS_PRESETS; ++i)
+    len += snprintf(out + len, size - len, "%s[%u,%u]", i ? "," : "", st->streaks[i].current, st->streaks[i].best);
+  len += snprintf(out + len, size - len, "]}\n");
+  return len;
+}
+
+static void bench_stats_report(void) {
+  // Um registro com todos os campos ocupados, como depois de dias de uso
+  session_snapshot_t aborted = { .preset = { 1, 2, 0 }, .cycles_remaining = 2, .work_minutes = 30,
+                                 .phase = PHASE_WORK, .phase_left = 600 };
+  session_t done = { .used = false, .work_minutes = 25, .preset = { 0, 1, 0 } };
+  stats_init(history_boot());
+  stats_session_aborted(&aborted);
+  for (uint i = 0; i < 1000; ++i) {
+    done.preset[1] = i % STATS_PRESETS;
+    stats_phase_end(&done, PHASE_WORK);
+    stats_phase_end(&done, PHASE_BREAK);
+  }
+
+  uint32_t next_seq = stats_get()->seq, ok = 0;
+  uint64_t ticks = 0;
+  sim_serial_read(NULL, 0);
+  for (uint32_t sent = 0; sent < BENCH_STATS_FRAMES; sent += BENCH_STATS_BATCH) {
+    uint32_t start = bench_ticks();
+    for (uint i = 0; i < BENCH_STATS_BATCH; ++i)
+      stats_send();
+    ticks += bench_elapsed(start, bench_ticks());
+    ok += bench_stats_check(&next_seq);
+  }
+
+  char text[256];
+  uint32_t json_bytes = 0;
+  uint32_t start = bench_ticks();
+  for (uint i = 0; i < BENCH_STATS_FRAMES; ++i)
+    json_bytes += bench_stats_json(text, sizeof(text), stats_get());
+  uint64_t json_ticks = bench_elapsed(start, bench_ticks());
+
+  double ns = ticks / bench_ticks_per_ns() / BENCH_STATS_FRAMES;
+  double json_ns = json_ticks / bench_ticks_per_ns() / BENCH_STATS_FRAMES;
+  uint32_t frame_bytes = LINK_OVERHEAD + sizeof(stats_t);
+  printf("{\"bench\":\"stats_stream\",\"platform\":\"%s\",\"frames\":%lu,\"frames_ok\":%lu,\"bytes_per_frame\":%lu,"
+         "\"usb_packets_per_frame\":%lu,\"ns_per_frame\":%.1f,\"mb_per_s\":%.1f,\"json_bytes\":%.1f,\"json_ns\":%.1f}\n",
+         BENCH_PLATFORM, (unsigned long) BENCH_STATS_FRAMES, (unsigned long) ok, (unsigned long) frame_bytes,
+         (unsigned long) ((frame_bytes + LINK_PACKET - 1) / LINK_PACKET), ns, frame_bytes * 1e3 / ns,
+         (double) json_bytes / BENCH_STATS_FRAMES, json_ns);
+}
+#endif
+
+// Tempo de barramento da inicialização e da janela de endereçamento de cada quadro, com um comando
+// por transação (legacy) e com a lista numa transação só. As escritas são bloqueantes, então o tempo
+// medido é o do barramento (virtual no host).
+static const uint8_t bench_init_sequence[] = {
+  SET_DISP | 0x00, SET_SCROLL_OFF, SET_MEM_ADDR, 0x01, SET_DISP_START_LINE | 0x00, SET_SEG_REMAP | 0x01,
+  SET_MUX_RATIO, HEIGHT - 1, SET_COM_OUT_DIR | 0x08, SET_DISP_OFFSET, 0x00, SET_COM_PIN_CFG, 0x12,
+  SET_DISP_CLK_DIV, 0x80, SET_PRECHARGE, 0xF1, SET_VCOM_DESEL, 0x30, SET_CONTRAST, 0xFF,
+  SET_ENTIRE_ON, SET_NORM_INV, SET_CHARGE_PUMP, 0x14, SET_DISP | 0x01,
+};
+static const uint8_t bench_window[] = { SET_COL_ADDR, 0, WIDTH - 1, SET_PAGE_ADDR, 0, HEIGHT / 8 - 1 };
+
+static double bench_command_us(const uint8_t *commands, size_t count, bool coalesced) {
+  uint64_t start_us = time_us_64();
+  for (uint32_t i = 0; i < BENCH_FLUSH_FRAMES; ++i) {
+    if (coalesced) {
+      ssd1306_cmdlist_t list;
+      ssd1306_cmdlist_init(&list);
+      ssd1306_cmdlist_append(&list, commands, count);
+      ssd1306_cmdlist_send(&ssd, &list);
+    } else {
+      for (size_t c = 0; c < count; ++c)
+        legacy_command(&ssd, commands[c]);
+    }
+  }
+  return (double) (time_us_64() - start_us) / BENCH_FLUSH_FRAMES;
+}
+
+static void bench_command_report(void) {
+  double init_legacy = bench_command_us(bench_init_sequence, sizeof(bench_init_sequence), false);
+  double init = bench_command_us(bench_init_sequence, sizeof(bench_init_sequence), true);
+  double window_legacy = bench_command_us(bench_window, sizeof(bench_window), false);
+  double window = bench_command_us(bench_window, sizeof(bench_window), true);
+  printf("{\"bench\":\"command_stream\",\"platform\":\"%s\",\"init_transactions_legacy\":%u,\"init_us_legacy\":%.1f,"
+         "\"init_transactions\":1,\"init_us\":%.1f,\"window_transactions_legacy\":%u,\"window_us_legacy\":%.1f,"
+         "\"window_transactions\":1,\"window_us\":%.1f,\"frame_us_saved\":%.1f}\n",
+         BENCH_PLATFORM, (unsigned) sizeof(bench_init_sequence), init_legacy, init,
+         (unsigned) sizeof(bench_window), window_legacy, window, window_legacy - window);
+}
+
+// Troca de trabalho para intervalo na tela do temporizador: bytes da cortina (inc/anim.c), de um envio
+// comum da mesma troca e de uma animação que reenviasse o quadro inteiro a cada passo.
+static void bench_anim_report(void) {
+  ui_state_t work = { .screen = UI_TIMER, .cycles_remaining = 4, .work_seconds = 3599, .work_total = 60, .break_total = 5 };
+  ui_state_t pause = work;
+  pause.work_seconds = 0;
+  pause.break_seconds = 300;
+
+  uint32_t bytes[2];
+  uint64_t busy_us[2];
+  for (uint wipe = 0; wipe < 2; ++wipe) {
+    ui_invalidate();
+    render_timer(&ssd, &work);
+    ssd1306_send_data(&ssd);
+    render_timer(&ssd, &pause);
+
+    uint32_t start = ssd.total_bytes;
+    uint64_t start_us = time_us_64();
+    if (wipe && anim_wipe(&ssd)) {
+      while (anim_running()) {
+        sleep_us(anim_wait_us());
+        anim_service(&ssd);
+      }
+      ssd1306_wait(&ssd);
+    } else {
+      ssd1306_send_data(&ssd);
+    }
+    bytes[wipe] = ssd.total_bytes - start;
+    busy_us[wipe] = time_us_64() - start_us;
+  }
+
+  uint32_t steps = HEIGHT / 8;
+  printf("{\"bench\":\"phase_wipe\",\"platform\":\"%s\",\"driver\":\"%s\",\"steps\":%lu,\"wipe_bytes\":%lu,"
+         "\"wipe_us\":%llu,\"plain_bytes\":%lu,\"full_frame_bytes\":%lu}\n",
+         BENCH_PLATFORM, BENCH_DRIVER, (unsigned long) steps, (unsigned long) bytes[1],
+         (unsigned long long) busy_us[1], (unsigned long) bytes[0], (unsigned long) (steps * (ssd.backend->window_bytes + SSD1306_BUFSIZE)));
+}
+
+static const uint8_t menu_values[3][6] = {
+  { 2, 3, 4, 5 },
+  { 20, 25, 30, 40, 50, 60 },
+  { 5, 10, 15 },
+};
+static const uint8_t menu_counts[3] = { 4, 6, 3 };
+
+// Tela de seleção do setup_menu, percorrendo as três etapas e suas opções
+static void run_scene_menu(uint32_t i) {
+  ui_state_t ui = { .screen = UI_MENU, .step = i % 3 };
+  ui.value = menu_values[ui.step][(i / 3) % menu_counts[ui.step]];
+  render_menu(&ssd, &ui);
+}
+
+// Mesmas cenas redesenhadas do zero a cada chamada, como antes dos widgets retidos
+static void run_scene_menu_full(uint32_t i) {
+  ui_invalidate();
+  run_scene_menu(i);
+}
+
+// Tela do temporizador em atividade, avançando um segundo por quadro
+static void bench_timer_frame(ssd1306_t *display, uint32_t i) {
+  uint32_t second = i % 3900;
+  ui_state_t ui = {
+    .screen = UI_TIMER,
+    .cycles_remaining = 4 - (i / 3900) % 4,
+    .work_seconds = second < 3600 ? second : 0,
+    .work_total = 60,
+    .break_seconds = second < 3600 ? 0 : 3900 - second,
+    .break_total = 5,
+  };
+  render_timer(display, &ui);
+}
+
+static void run_scene_timer(uint32_t i) {
+  bench_timer_frame(&ssd, i);
+}
+
+static void run_scene_timer_full(uint32_t i) {
+  ui_invalidate();
+  run_scene_timer(i);
+}
+
+static const bench_case_t bench_cases[] = {
+  { "pixel",                run_pixel,               1,                  false },
+  { "fill",                 run_fill,                WIDTH * HEIGHT,     false },
+  { "fill_legacy",          run_fill_legacy,         WIDTH * HEIGHT,     false },
+  { "rect",                 run_rect,                2 * 124 + 2 * 58,   false },
+  { "rect_legacy",          run_rect_legacy,         2 * 124 + 2 * 58,   false },
+  { "rect_fill",            run_rect_fill,           64 * 40,            false },
+  { "rect_fill_legacy",     run_rect_fill_legacy,    64 * 40,            false },
+  { "line",                 run_line,                128,                false },
+  { "hline",                run_hline,               128,                false },
+  { "vline",                run_vline,               64,                 false },
+  { "draw_char",            run_draw_char,           64,                 false },
+  { "draw_char_unaligned",  run_draw_char_unaligned, 64,                 false },
+  { "draw_char_legacy",     run_draw_char_legacy,    64,                 false },
+  { "draw_string",          run_draw_string,         64 * 15,            false },
+  { "draw_digit",           run_draw_digit,          17 * 32,            false },
+  { "draw_digit_unaligned", run_draw_digit_unaligned, 17 * 32,           false },
+  { "draw_clock",           run_draw_clock,          76 * 32,            false },
+  { "scene_menu",           run_scene_menu,          WIDTH * HEIGHT,     true },
+  { "scene_menu_full",      run_scene_menu_full,     WIDTH * HEIGHT,     true },
+  { "scene_timer",          run_scene_timer,         WIDTH * HEIGHT,     true },
+  { "scene_timer_full",     run_scene_timer_full,    WIDTH * HEIGHT,     true },
+  { "event_ring",           run_event_ring,          0,                  false },
+  { "event_batch8",         run_event_batch,         0,                  false },
+  { "wheel_tick_1",         run_wheel_tick_1,        0,                  false },
+  { "wheel_tick_32",        run_wheel_tick_32,       0,                  false },
+  { "wheel_tick_1024",      run_wheel_tick_1024,     0,                  false },
+  { "history_append",       run_history_append,      0,                  false },
+  { "trace_record",         run_trace_record,        0,                  false },
+};
+
+// Executa o caso em blocos de tamanho crescente até acumular BENCH_MIN_CHUNKS blocos cheios.
+// Retorna os ticks totais e a quantidade de chamadas em `calls`.
+static uint64_t bench_measure(const bench_case_t *b, uint32_t *calls) {
+  uint64_t total = 0;
+  uint32_t n = 0, chunk = 1, full = 0;
+
+  while (full < BENCH_MIN_CHUNKS) {
+    uint32_t start = bench_ticks();
+    for (uint32_t i = 0; i < chunk; ++i)
+      b->run(n + i);
+    uint32_t elapsed = bench_elapsed(start, bench_ticks());
+
+    total += elapsed;
+    n += chunk;
+    if (elapsed < BENCH_CHUNK_TICKS / 2)
+      chunk *= 2;
+    else
+      full++;
+  }
+
+  *calls = n;
+  return total;
+}
+
+// Envia BENCH_FLUSH_FRAMES quadros consecutivos da cena, como o programa faria a cada mudança de estado.
+// O primeiro quadro da sequência sai antes da medição, para que ela não dependa de onde a anterior parou.
+static void bench_flush(const bench_case_t *b, double *bytes_per_flush, double *flush_us) {
+  b->run(0);
+  ssd1306_send_data(&ssd);
+  uint32_t bytes = ssd.total_bytes;
+  uint64_t busy_us = 0;
+
+  for (uint32_t i = 1; i <= BENCH_FLUSH_FRAMES; ++i) {
+    b->run(i);
+    uint64_t start_us = time_us_64();
+    ssd1306_send_data(&ssd);
+    busy_us += time_us_64() - start_us;
+  }
+
+  *bytes_per_flush = (double) (ssd.total_bytes - bytes) / BENCH_FLUSH_FRAMES;
+  *flush_us = (double) busy_us / BENCH_FLUSH_FRAMES;
+}
+
+// Memória dos buffers do driver: no heap (versão parametrizada em tempo de execução) ou em .bss
+// (SSD1306_STATIC). `heap_saved` é o que ssd1306_init alocaria sem a especialização.
+static void bench_driver_report(void) {
+  uint32_t runtime_heap = 2 * SSD1306_BUFSIZE - 1 + 2 * SSD1306_DMA_WORDS * sizeof(uint16_t);
+  uint32_t static_bytes = SSD1306_STATIC ? 3 + 2 * SSD1306_BUFSIZE - 1 + 2 * SSD1306_DMA_WORDS * sizeof(uint16_t) : 0;
+  printf("{\"bench\":\"driver_memory\",\"platform\":\"%s\",\"driver\":\"%s\",\"heap_bytes\":%lu,"
+         "\"static_bytes\":%lu,\"heap_saved\":%lu}\n",
+         BENCH_PLATFORM, BENCH_DRIVER, (unsigned long) ssd.heap_bytes, (unsigned long) static_bytes,
+         (unsigned long) (runtime_heap - ssd.heap_bytes));
+}
+
+#if !SSD1306_STATIC
+// Controladores comparados em bench_backend_report. Na placa só existe o painel montado; no host o
+// simulador decodifica os dois controladores e o backend de memória mede a montagem do envio sem barramento.
+typedef struct {
+  const ssd1306_backend_t *backend;
+  uint8_t height;
+} bench_panel_t;
+
+static const bench_panel_t bench_panels[] = {
+#if PICO_ON_DEVICE
+  { SSD1306_BACKEND, HEIGHT },
+#else
+  { &ssd1306_backend_ssd1306, 64 },
+  { &ssd1306_backend_ssd1306, 32 },
+  { &ssd1306_backend_sh1106, 64 },
+  { &ssd1306_backend_mock, 64 },
+#endif
+};
+
+#if !PICO_ON_DEVICE
+// Confere a imagem do painel (decodificada pelo simulador ou gravada pelo backend de memória) com o buffer
+static bool bench_panel_matches(const ssd1306_t *display) {
+  for (uint y = 0; y < display->height; ++y)
+    for (uint x = 0; x < display->width; ++x) {
+      bool expected = display->ram_buffer[1 + x * display->pages + (y >> 3)] & (1u << (y & 7));
+      bool shown = display->backend == &ssd1306_backend_mock ? mock_panel_pixel(x, y) : sim_pixel(x, y);
+      if (shown != expected)
+        return false;
+    }
+  return true;
+}
+#endif
+
+// A mesma sequência de quadros do temporizador em cada controlador: bytes e tempo de barramento por envio
+// e o tempo de processador do envio (no host, com o decodificador do simulador junto, exceto no mock).
+static void bench_backend_report(void) {
+  // Cada painel fica com o seu canal DMA, que a interrupção associa ao display
+  static ssd1306_t panels[count_of(bench_panels)];
+  for (uint i = 0; i < count_of(bench_panels); ++i) {
+    ssd1306_t *display = &panels[i];
+    ssd1306_init(display, bench_panels[i].backend, WIDTH, bench_panels[i].height, false, endereco, I2C_PORT);
+    ssd1306_config(display);
+    ui_invalidate();
+    bench_timer_frame(display, 0);
+    ssd1306_send_data(display);
+
+    uint32_t bytes = display->total_bytes;
+    uint64_t busy_us = 0, ticks = 0;
+    for (uint32_t f = 1; f <= BENCH_FLUSH_FRAMES; ++f) {
+      bench_timer_frame(display, f);
+      uint64_t start_us = time_us_64();
+      uint32_t start = bench_ticks();
+      ssd1306_send_data(display);
+      ticks += bench_elapsed(start, bench_ticks());
+      busy_us += time_us_64() - start_us;
+    }
+
+    printf("{\"bench\":\"backend_flush\",\"platform\":\"%s\",\"driver\":\"%s\",\"backend\":\"%s\",\"height\":%u,"
+           "\"bytes_per_flush\":%.1f,\"flush_us\":%.1f,\"ns_per_flush\":%.1f",
+           BENCH_PLATFORM, BENCH_DRIVER, display->backend->name, (unsigned) display->height,
+           (double) (display->total_bytes - bytes) / BENCH_FLUSH_FRAMES, (double) busy_us / BENCH_FLUSH_FRAMES,
+           ticks / bench_ticks_per_ns() / BENCH_FLUSH_FRAMES);
+#if !PICO_ON_DEVICE
+    printf(",\"image_ok\":%s", bench_panel_matches(display) ? "true" : "false");
+#endif
+    printf("}\n");
+  }
+
+  // O display do benchmark volta a ser o painel da placa, com a GDDRAM desconhecida
+  ssd1306_config(&ssd);
+  ssd.shadow_valid = false;
+  ssd1306_mark_dirty(&ssd, 0, 0, WIDTH - 1, HEIGHT - 1);
+  ui_invalidate();
+}
+#endif
+
+static uint32_t bench_run(const bench_case_t *b) {
+  // Parte sempre da tela apagada e já enviada, para que a região suja não acumule entre casos
+  ssd1306_fill(&ssd, false);
+  ssd1306_send_data(&ssd);
+  ui_invalidate();
+
+  uint32_t calls;
+  uint64_t ticks = bench_measure(b, &calls);
+  double ns_per_call = ticks / bench_ticks_per_ns() / calls;
+
+  printf("{\"bench\":\"%s\",\"platform\":\"%s\",\"driver\":\"%s\",\"calls\":%lu,\"ns_per_call\":%.1f",
+         b->name, BENCH_PLATFORM, BENCH_DRIVER, (unsigned long) calls, ns_per_call);
+  if (b->pixels)
+    printf(",\"pixels_per_s\":%.0f", b->pixels * 1e9 / ns_per_call);
+
+  if (b->scene) {
+    double bytes_per_flush, flush_us;
+    bench_flush(b, &bytes_per_flush, &flush_us);
+    printf(",\"bytes_per_flush\":%.1f,\"flush_us\":%.1f", bytes_per_flush, flush_us);
+  }
+  printf("}\n");
+  return calls;
+}
+
+int main() {
+#if PICO_ON_DEVICE
+  // Na placa os resultados saem pela USB; espera o terminal abrir para não perder as primeiras linhas
+  stdio_init_all();
+  while (!stdio_usb_connected())
+    sleep_ms(100);
+#endif
+
+  i2c_init(I2C_PORT, 400 * 1000);
+  gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+  gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+  gpio_pull_up(I2C_SDA);
+  gpio_pull_up(I2C_SCL);
+
+  ssd1306_init(&ssd, SSD1306_BACKEND, WIDTH, HEIGHT, false, endereco, I2C_PORT);
+  ssd1306_config(&ssd);
+  bench_clock_init();
+  event_ring_init(&bench_events, bench_event_buffer, count_of(bench_event_buffer));
+  history_init();
+
+  for (uint i = 0; i < count_of(bench_cases); ++i) {
+    uint32_t calls = bench_run(&bench_cases[i]);
+    if (bench_cases[i].run == run_history_append)
+      bench_history_report(calls);
+  }
+  bench_command_report();
+#if !PICO_ON_DEVICE
+  bench_stats_report();
+#endif
+  bench_anim_report();
+  bench_driver_report();
+#if !SSD1306_STATIC
+  bench_backend_report();
+#endif
+
+#if PICO_ON_DEVICE
+  while (true)
+    sleep_ms(1000);
+#endif
+  return 0;
+}
@@ -0,0 +1,30 @@
+# Font tables generated at build time by tools/fontgen.py from the BDF/PSF sources in fonts/.
+# pomodoro_add_fonts() adds the pomodoro_fonts library in the calling directory; the tables are const
+# (flash on the board) and the generator prints each font's footprint during the build.
+
+find_package(Python3 REQUIRED COMPONENTS Interpreter)
+
+set(POMODORO_FONTS_DIR ${CMAKE_CURRENT_LIST_DIR})
+set(POMODORO_FONTGEN ${CMAKE_CURRENT_LIST_DIR}/../tools/fontgen.py)
+
+# name=source[:first-last]; the range defaults to 32-126
+set(POMODORO_FONTS
+    font_8x8=${POMODORO_FONTS_DIR}/pomodoro-8x8.bdf
+    font_digits=${POMODORO_FONTS_DIR}/digits-16x32.bdf:32-58
+)
+
+function(pomodoro_add_fonts)
+    set(out ${CMAKE_CURRENT_BINARY_DIR}/fonts.c)
+    set(sources ${POMODORO_FONTS})
+    list(TRANSFORM sources REPLACE "^[^=]*=" "")
+    list(TRANSFORM sources REPLACE ":[0-9]+-[0-9]+$" "")
+    add_custom_command(
+        OUTPUT ${out}
+        COMMAND ${Python3_EXECUTABLE} ${POMODORO_FONTGEN} -o ${out} ${POMODORO_FONTS}
+        DEPENDS ${POMODORO_FONTGEN} ${sources}
+        COMMENT "Generating font tables"
+        VERBATIM
+    )
+    add_library(pomodoro_fonts STATIC ${out})
+    target_include_directories(pomodoro_fonts PRIVATE ${POMODORO_FONTS_DIR}/..)
+endfunction()
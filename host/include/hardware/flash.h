@@ -0,0 +1,23 @@
+#ifndef _HARDWARE_FLASH_H
+#define _HARDWARE_FLASH_H
+
+// Substituto de host para hardware/flash.h. A flash é uma imagem em memória, opcionalmente mapeada
+// de um arquivo (POMODORO_SIM_FLASH), lida pelo endereço XIP como no dispositivo. Como numa NOR,
+// apagar leva os bytes a 0xFF e gravar só pode levar bits de 1 para 0.
+
+#include "pico/types.h"
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+
+const uint8_t *sim_flash_xip(void);
+#define XIP_BASE ((uintptr_t) sim_flash_xip())
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _HARDWARE_SYNC_H
+#define _HARDWARE_SYNC_H
+
+// No simulador as "interrupções" (alarmes, DMA, GPIO) só rodam dentro das esperas,
+// então as seções críticas não precisam mascarar nada.
+
+#include "pico/types.h"
+
+void sim_idle(void);
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void) status; }
+static inline void __dmb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __dsb(void) { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+static inline void __sev(void) {}
+static inline void __wfi(void) { sim_idle(); }
+static inline void __wfe(void) { sim_idle(); }
+
+#endif
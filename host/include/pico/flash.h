@@ -0,0 +1,19 @@
+#ifndef _PICO_FLASH_H
+#define _PICO_FLASH_H
+
+// Substituto de host para pico/flash.h: o núcleo 1 do simulador é uma corrotina e não roda durante a chamada,
+// então não há nada a pausar.
+
+#include "pico/types.h"
+
+#define PICO_OK 0
+
+static inline bool flash_safe_execute_core_init(void) { return true; }
+
+static inline int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms) {
+    (void) enter_exit_timeout_ms;
+    func(param);
+    return PICO_OK;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef _PICO_MULTICORE_H
+#define _PICO_MULTICORE_H
+
+// Substituto de host para pico/multicore.h: o núcleo 1 é uma corrotina do simulador, que roda até
+// esperar (__wfe, __wfi) e devolve o controle ao núcleo 0. A FIFO entre os núcleos não existe aqui: no
+// firmware ela pertence à pausa do núcleo 1 durante as gravações na flash.
+
+#include "pico/types.h"
+
+void multicore_launch_core1(void (*entry)(void));
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef _PICO_STDIO_USB_H
+#define _PICO_STDIO_USB_H
+
+// Substituto de host para pico/stdio_usb.h: a porta serial da USB CDC, sempre conectada. Os bytes
+// escritos pelo driver vão para um arquivo (POMODORO_SIM_SERIAL) e para uma captura lida por
+// sim_serial_read; o texto do printf continua indo para a saída padrão.
+
+#include "pico/types.h"
+
+typedef struct stdio_driver {
+    void (*out_chars)(const char *buf, int len);
+    void (*out_flush)(void);
+    int (*in_chars)(char *buf, int len);
+} stdio_driver_t;
+
+extern stdio_driver_t stdio_usb;
+
+bool stdio_usb_connected(void);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _PICO_STDLIB_H
+#define _PICO_STDLIB_H
+
+// Substituto de host para pico/stdlib.h: reúne tipos, tempo e GPIO como no Pico SDK.
+
+#include <assert.h>
+#include <stdio.h>
+#include "pico/types.h"
+#include "pico/time.h"
+#include "hardware/gpio.h"
+
+#define PICO_ERROR_TIMEOUT (-1)
+
+#define hard_assert(condition) assert(condition)
+
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+
+#endif
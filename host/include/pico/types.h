@@ -0,0 +1,24 @@
+#ifndef _PICO_TYPES_H
+#define _PICO_TYPES_H
+
+// Substituto de host para pico/types.h e pico/platform.h do Pico SDK.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define __not_in_flash_func(func_name) func_name
+#define __isr
+#define __aligned(x) __attribute__((aligned(x)))
+
+static inline void tight_loop_contents(void) {}
+
+// Núcleo em execução: 1 só dentro da corrotina do núcleo 1 (pico/multicore.h)
+uint sim_core_num(void);
+static inline uint get_core_num(void) { return sim_core_num(); }
+
+#endif
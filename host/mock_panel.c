@@ -0,0 +1,52 @@
+#include <string.h>
+#include "mock_panel.h"
+
+static uint8_t mock_gddram[WIDTH * SSD1306_MAX_PAGES];
+static uint64_t mock_bytes;
+
+static void mock_init(ssd1306_cmdlist_t *list, uint8_t width, uint8_t height, bool external_vcc) {
+    (void) list;
+    (void) width;
+    (void) height;
+    (void) external_vcc;
+    memset(mock_gddram, 0, sizeof(mock_gddram));
+}
+
+// Não há endereçamento: write_span recebe a própria janela
+static uint16_t *mock_set_window(uint16_t *out, const uint8_t *lead, uint8_t lead_count,
+                                 uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+    (void) lead;
+    (void) lead_count;
+    (void) x0;
+    (void) x1;
+    (void) p0;
+    (void) p1;
+    return out;
+}
+
+static uint16_t *mock_write_span(uint16_t *out, const uint8_t *frame, uint8_t pages,
+                                 uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+    uint8_t span = p1 - p0 + 1;
+    for (uint x = x0; x <= x1; ++x)
+        memcpy(&mock_gddram[x * SSD1306_MAX_PAGES + p0], &frame[x * pages + p0], span);
+    mock_bytes += (x1 - x0 + 1) * span;
+    return out;
+}
+
+const ssd1306_backend_t ssd1306_backend_mock = {
+    .name = "mock",
+    .window_bytes = 0,
+    .paged = false,
+    .scroll = false,
+    .init = mock_init,
+    .set_window = mock_set_window,
+    .write_span = mock_write_span,
+};
+
+bool mock_panel_pixel(uint x, uint y) {
+    return mock_gddram[x * SSD1306_MAX_PAGES + (y >> 3)] & (1u << (y & 7));
+}
+
+uint64_t mock_panel_bytes(void) {
+    return mock_bytes;
+}
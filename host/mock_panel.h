@@ -0,0 +1,16 @@
+#ifndef _POMODORO_MOCK_PANEL_H
+#define _POMODORO_MOCK_PANEL_H
+
+// Backend de memória do driver do display, para os benchmarks no host. Implementa a mesma interface dos
+// controladores (ssd1306_backend_t), mas a janela e os dados vão direto para uma imagem da GDDRAM, sem
+// nenhum byte no barramento: a mesma sequência de quadros mede só o custo de CPU da montagem do envio.
+// Recebe apenas quadros; comandos avulsos (contraste, animações) continuam indo para o I2C.
+
+#include "inc/ssd1306.h"
+
+extern const ssd1306_backend_t ssd1306_backend_mock;
+
+bool mock_panel_pixel(uint x, uint y);
+uint64_t mock_panel_bytes(void);    // Bytes gravados na imagem desde o início
+
+#endif
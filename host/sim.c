@@ -0,0 +1,1172 @@
+// Simulador de host: implementa as funções do Pico SDK usadas pelo firmware sobre um relógio virtual.
+//
+// O tempo só avança quando o programa espera (sleep_*, __wfi, __wfe) ou ocupa o barramento I2C,
+// e os alarmes, temporizadores, fins de DMA e entradas roteirizadas disparam nessas esperas,
+// na ordem dos seus instantes. Uma sessão de horas roda em milissegundos. No modo de dois núcleos o
+// núcleo 1 é uma corrotina: cada espera do núcleo 0 o deixa rodar até ele mesmo esperar.
+//
+// Variáveis de ambiente:
+//   POMODORO_SIM_SCRIPT  eventos "ms:ação" separados por vírgula. Ações: B (aperta o botão B),
+//                        R / L (joystick para a direita / esquerda por 250 ms), P / T (envia 'p' / 't'
+//                        pelo stdio: relatório do perfil / trace pela porta serial da USB), S (imprime a
+//                        tela daquele instante).
+//   POMODORO_SIM_END_MS  instante virtual em que a simulação termina.
+//   POMODORO_SIM_DUMP    arquivo PBM onde a imagem final do display é gravada.
+//   POMODORO_SIM_FLASH   arquivo com a imagem da flash; o histórico persiste entre execuções.
+//   POMODORO_SIM_ALARM_JITTER_US  atraso máximo, sorteado a cada disparo, da interrupção dos alarmes de hardware.
+//   POMODORO_SIM_SERIAL  arquivo que recebe os bytes escritos na porta serial da USB (quadros de inc/link.c).
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "sim.h"
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/flash.h"
+#include "hardware/timer.h"
+#include "hardware/i2c.h"
+#include "hardware/irq.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "pico/stdio_usb.h"
+
+#define SIM_MAX_EVENTS 64
+#define SIM_BUTTON_B 6
+#define SIM_JOYSTICK_INPUT 1
+
+// Roteiro padrão: 4 ciclos, 60 minutos de trabalho e 5 de intervalo (~260 minutos de sessão)
+#define SIM_DEFAULT_SCRIPT "500:R,1000:R,1500:B,2000:L,2500:B,3000:B"
+#define SIM_DEFAULT_END_MS (270u * 60u * 1000u)
+
+static uint64_t sim_now_us;
+static sim_stats_t sim_stats;
+static struct timespec sim_wall_start;
+static const char *sim_dump_path;
+
+// ---------------------------------------------------------------------------
+// Fila de eventos do relógio virtual
+
+enum { EV_FREE, EV_ALARM, EV_REPEATING, EV_HW_ALARM, EV_CALL };
+
+typedef struct {
+    int kind;
+    uint64_t at;
+    uint64_t seq;
+    alarm_id_t id;
+    alarm_callback_t alarm;
+    struct repeating_timer *timer;
+    sim_event_fn_t fn;
+    void *user_data;
+} sim_event_t;
+
+static sim_event_t sim_events[SIM_MAX_EVENTS];
+static uint64_t sim_event_seq;
+static alarm_id_t sim_next_alarm_id = 1;
+static hardware_alarm_callback_t sim_hw_alarm_callback[NUM_TIMERS];
+
+static sim_event_t *sim_event_alloc(int kind, uint64_t at) {
+    for (uint i = 0; i < SIM_MAX_EVENTS; ++i) {
+        if (sim_events[i].kind == EV_FREE) {
+            memset(&sim_events[i], 0, sizeof(sim_events[i]));
+            sim_events[i].kind = kind;
+            sim_events[i].at = at;
+            sim_events[i].seq = sim_event_seq++;
+            return &sim_events[i];
+        }
+    }
+    fprintf(stderr, "[sim] fila de eventos cheia\n");
+    abort();
+}
+
+static sim_event_t *sim_event_next(void) {
+    sim_event_t *next = NULL;
+    for (uint i = 0; i < SIM_MAX_EVENTS; ++i) {
+        sim_event_t *ev = &sim_events[i];
+        if (ev->kind == EV_FREE)
+            continue;
+        if (!next || ev->at < next->at || (ev->at == next->at && ev->seq < next->seq))
+            next = ev;
+    }
+    return next;
+}
+
+static void sim_event_fire(sim_event_t *ev) {
+    if (ev->at > sim_now_us)
+        sim_now_us = ev->at;
+
+    switch (ev->kind) {
+    case EV_ALARM: {
+        alarm_id_t id = ev->id;
+        int64_t next = ev->alarm(id, ev->user_data);
+        // O callback pode ter cancelado o próprio alarme
+        if (ev->kind != EV_ALARM || ev->id != id)
+            break;
+        if (next > 0) {
+            ev->at += next;
+            ev->seq = sim_event_seq++;
+        } else if (next < 0) {
+            ev->at = sim_now_us - next;
+            ev->seq = sim_event_seq++;
+        } else {
+            ev->kind = EV_FREE;
+        }
+        break;
+    }
+    case EV_REPEATING: {
+        struct repeating_timer *rt = ev->timer;
+        alarm_id_t id = ev->id;
+        bool again = rt->callback(rt);
+        if (ev->kind != EV_REPEATING || ev->id != id)
+            break;
+        if (again) {
+            ev->at = rt->delay_us > 0 ? ev->at + rt->delay_us : sim_now_us - rt->delay_us;
+            ev->seq = sim_event_seq++;
+        } else {
+            ev->kind = EV_FREE;
+        }
+        break;
+    }
+    case EV_HW_ALARM:
+        ev->kind = EV_FREE;
+        sim_hw_alarm_callback[ev->id](ev->id);
+        break;
+    case EV_CALL:
+        ev->kind = EV_FREE;
+        ev->fn(ev->user_data);
+        break;
+    }
+}
+
+// Dispara, em ordem, todos os eventos com instante até `limit` e leva o relógio até lá.
+static void sim_run_until(uint64_t limit) {
+    sim_event_t *ev;
+    while ((ev = sim_event_next()) && ev->at <= limit)
+        sim_event_fire(ev);
+    if (limit > sim_now_us)
+        sim_now_us = limit;
+}
+
+void sim_schedule(uint64_t at_us, sim_event_fn_t fn, void *user_data) {
+    sim_event_t *ev = sim_event_alloc(EV_CALL, at_us);
+    ev->fn = fn;
+    ev->user_data = user_data;
+}
+
+void sim_advance(uint64_t us) {
+    sim_run_until(sim_now_us + us);
+}
+
+// ---------------------------------------------------------------------------
+// Núcleos (pico/multicore.h)
+
+#define SIM_CORE1_STACK (256 * 1024)
+
+static ucontext_t sim_core_context[2];
+static uint sim_core;               // Núcleo em execução
+static bool sim_core1_launched;
+
+uint sim_core_num(void) {
+    return sim_core;
+}
+
+static void sim_core_switch(uint to) {
+    uint from = sim_core;
+    sim_core = to;
+    swapcontext(&sim_core_context[from], &sim_core_context[to]);
+}
+
+static void (*sim_core1_entry)(void);
+
+static void sim_core1_start(void) {
+    sim_core1_entry();
+    fprintf(stderr, "[sim] o laço do nucleo 1 retornou\n");
+    exit(1);
+}
+
+// O núcleo 1 começa já, e roda até a primeira espera.
+void multicore_launch_core1(void (*entry)(void)) {
+    sim_core1_entry = entry;
+    getcontext(&sim_core_context[1]);
+    sim_core_context[1].uc_stack.ss_sp = malloc(SIM_CORE1_STACK);
+    sim_core_context[1].uc_stack.ss_size = SIM_CORE1_STACK;
+    sim_core_context[1].uc_link = NULL;
+    makecontext(&sim_core_context[1], sim_core1_start, 0);
+    sim_core1_launched = true;
+    sim_core_switch(1);
+}
+
+// Equivalente a dormir até a próxima interrupção: salta direto para o próximo evento. Uma espera do núcleo
+// 1 devolve o controle ao núcleo 0; antes de o núcleo 0 dormir, o núcleo 1 roda até esperar de novo,
+// então o que ele publicou (quadros, DMA) já está agendado quando o relógio avança.
+void sim_idle(void) {
+    if (sim_core == 1) {
+        sim_core_switch(0);
+        return;
+    }
+    if (sim_core1_launched)
+        sim_core_switch(1);
+
+    sim_event_t *ev = sim_event_next();
+    if (!ev) {
+        fprintf(stderr, "[sim] nenhum evento agendado; o programa dormiria para sempre\n");
+        exit(1);
+    }
+    sim_stats.wakeups++;
+    sim_run_until(ev->at);
+}
+
+// ---------------------------------------------------------------------------
+// Tempo e alarmes (pico/time.h)
+
+uint64_t time_us_64(void) {
+    return sim_now_us;
+}
+
+void sleep_until(absolute_time_t target) {
+    sim_run_until(target);
+}
+
+void sleep_us(uint64_t us) {
+    sim_run_until(sim_now_us + us);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t) ms * 1000);
+}
+
+alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    if (time < sim_now_us && !fire_if_past)
+        return 0;
+    sim_event_t *ev = sim_event_alloc(EV_ALARM, time < sim_now_us ? sim_now_us : time);
+    ev->id = sim_next_alarm_id++;
+    ev->alarm = callback;
+    ev->user_data = user_data;
+    return ev->id;
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_at(sim_now_us + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+    return add_alarm_in_us((uint64_t) ms * 1000, callback, user_data, fire_if_past);
+}
+
+static bool sim_cancel(int kind, alarm_id_t id) {
+    for (uint i = 0; i < SIM_MAX_EVENTS; ++i) {
+        if (sim_events[i].kind == kind && sim_events[i].id == id) {
+            sim_events[i].kind = EV_FREE;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool cancel_alarm(alarm_id_t alarm_id) {
+    return sim_cancel(EV_ALARM, alarm_id);
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, struct repeating_timer *out) {
+    uint64_t delay = delay_us < 0 ? -delay_us : delay_us;
+    sim_event_t *ev = sim_event_alloc(EV_REPEATING, sim_now_us + delay);
+    ev->id = sim_next_alarm_id++;
+    ev->timer = out;
+    out->delay_us = delay_us;
+    out->alarm_id = ev->id;
+    out->callback = callback;
+    out->user_data = user_data;
+    return true;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, struct repeating_timer *out) {
+    return add_repeating_timer_us((int64_t) delay_ms * 1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(struct repeating_timer *timer) {
+    return sim_cancel(EV_REPEATING, timer->alarm_id);
+}
+
+// ---------------------------------------------------------------------------
+// Alarmes de hardware (hardware/timer.h)
+
+static bool sim_hw_alarm_claimed[NUM_TIMERS];
+static uint32_t sim_alarm_jitter_us;
+static uint32_t sim_jitter_seed = 1;
+
+// Latência simulada da interrupção do alarme, pseudoaleatória e reprodutível
+static uint32_t sim_alarm_latency_us(void) {
+    if (!sim_alarm_jitter_us)
+        return 0;
+    sim_jitter_seed = sim_jitter_seed * 1103515245u + 12345u;
+    return (sim_jitter_seed >> 8) % (sim_alarm_jitter_us + 1);
+}
+
+void hardware_alarm_claim(uint alarm_num) {
+    if (sim_hw_alarm_claimed[alarm_num]) {
+        fprintf(stderr, "[sim] alarme de hardware %u ja reservado\n", alarm_num);
+        abort();
+    }
+    sim_hw_alarm_claimed[alarm_num] = true;
+}
+
+// O alarme 3 fica com o pool de alarmes padrão do SDK, como no dispositivo
+int hardware_alarm_claim_unused(bool required) {
+    for (uint i = 0; i < NUM_TIMERS - 1; ++i) {
+        if (!sim_hw_alarm_claimed[i]) {
+            sim_hw_alarm_claimed[i] = true;
+            return (int) i;
+        }
+    }
+    if (required) {
+        fprintf(stderr, "[sim] sem alarmes de hardware livres\n");
+        abort();
+    }
+    return -1;
+}
+
+void hardware_alarm_unclaim(uint alarm_num) {
+    hardware_alarm_cancel(alarm_num);
+    sim_hw_alarm_claimed[alarm_num] = false;
+}
+
+void hardware_alarm_set_callback(uint alarm_num, hardware_alarm_callback_t callback) {
+    sim_hw_alarm_callback[alarm_num] = callback;
+}
+
+bool hardware_alarm_set_target(uint alarm_num, absolute_time_t t) {
+    sim_cancel(EV_HW_ALARM, (alarm_id_t) alarm_num);
+    if (t <= sim_now_us)
+        return true;
+    sim_event_t *ev = sim_event_alloc(EV_HW_ALARM, t + sim_alarm_latency_us());
+    ev->id = (alarm_id_t) alarm_num;
+    return false;
+}
+
+void hardware_alarm_cancel(uint alarm_num) {
+    sim_cancel(EV_HW_ALARM, (alarm_id_t) alarm_num);
+}
+
+// ---------------------------------------------------------------------------
+// Interrupções
+
+#define SIM_MAX_SHARED_HANDLERS 4
+
+static irq_handler_t sim_irq_handlers[NUM_IRQS][SIM_MAX_SHARED_HANDLERS];
+static bool sim_irq_enabled[NUM_IRQS];
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    memset(sim_irq_handlers[num], 0, sizeof(sim_irq_handlers[num]));
+    sim_irq_handlers[num][0] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void) order_priority;
+    for (uint i = 0; i < SIM_MAX_SHARED_HANDLERS; ++i) {
+        if (!sim_irq_handlers[num][i] || sim_irq_handlers[num][i] == handler) {
+            sim_irq_handlers[num][i] = handler;
+            return;
+        }
+    }
+    fprintf(stderr, "[sim] handlers demais na IRQ %u\n", num);
+    abort();
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    sim_irq_enabled[num] = enabled;
+}
+
+void irq_set_priority(uint num, uint8_t hardware_priority) {
+    (void) num;
+    (void) hardware_priority;
+}
+
+static void sim_raise_irq(uint num) {
+    if (!sim_irq_enabled[num])
+        return;
+    for (uint i = 0; i < SIM_MAX_SHARED_HANDLERS && sim_irq_handlers[num][i]; ++i)
+        sim_irq_handlers[num][i]();
+}
+
+// ---------------------------------------------------------------------------
+// GPIO e ADC
+
+static bool sim_gpio_level[NUM_BANK0_GPIOS];
+static uint32_t sim_gpio_irq_mask[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t sim_gpio_callback;
+
+static uint16_t sim_adc_value[5] = { 2048, 2048, 2048, 2048, 2048 };
+static uint sim_adc_input;
+
+static void sim_setup(void);
+
+// Primeira chamada do firmware em setup(): é aqui que o roteiro da simulação começa a valer
+bool stdio_init_all(void) {
+    sim_setup();
+    return true;
+}
+
+// Entrada do stdio: só os caracteres colocados pelo roteiro (ações 'P' e 'T'), nunca bloqueia.
+static char sim_stdin[16];
+static uint sim_stdin_head, sim_stdin_tail;
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    (void) timeout_us;
+    if (sim_stdin_tail == sim_stdin_head)
+        return PICO_ERROR_TIMEOUT;
+    return sim_stdin[sim_stdin_tail++ % sizeof(sim_stdin)];
+}
+
+void gpio_init(uint gpio) { sim_gpio_level[gpio] = false; }
+void gpio_set_dir(uint gpio, bool out) { (void) gpio; (void) out; }
+void gpio_set_function(uint gpio, enum gpio_function fn) { (void) gpio; (void) fn; }
+void gpio_pull_up(uint gpio) { sim_gpio_level[gpio] = true; }
+void gpio_pull_down(uint gpio) { sim_gpio_level[gpio] = false; }
+void gpio_put(uint gpio, bool value) { sim_gpio_level[gpio] = value; }
+bool gpio_get(uint gpio) { return sim_gpio_level[gpio]; }
+
+void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) {
+    if (enabled)
+        sim_gpio_irq_mask[gpio] |= events;
+    else
+        sim_gpio_irq_mask[gpio] &= ~events;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    gpio_set_irq_enabled(gpio, events, enabled);
+    sim_gpio_callback = callback;
+}
+
+static void sim_gpio_drive(uint gpio, bool level) {
+    if (sim_gpio_level[gpio] == level)
+        return;
+    sim_gpio_level[gpio] = level;
+    uint32_t event = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if ((sim_gpio_irq_mask[gpio] & event) && sim_gpio_callback)
+        sim_gpio_callback(gpio, event);
+}
+
+static void sim_release_button(void *user_data) {
+    sim_gpio_drive((uint) (uintptr_t) user_data, true);
+}
+
+// Botões da placa são ativos em nível baixo (pull-up)
+void sim_press_button(uint gpio, uint32_t hold_ms) {
+    sim_gpio_drive(gpio, false);
+    sim_schedule(sim_now_us + (uint64_t) hold_ms * 1000, sim_release_button, (void *) (uintptr_t) gpio);
+}
+
+void sim_set_adc(uint input, uint16_t value) {
+    sim_adc_value[input] = value;
+}
+
+void adc_init(void) {}
+void adc_gpio_init(uint gpio) { (void) gpio; }
+void adc_select_input(uint input) { sim_adc_input = input; }
+uint16_t adc_read(void) { return sim_adc_value[sim_adc_input]; }
+
+// Modo contínuo. Em vez de um evento por conversão, um evento a cada `thresh` conversões
+// coloca as amostras na FIFO e levanta a interrupção, como o hardware faria ao atingir o limiar.
+#define SIM_ADC_FIFO_DEPTH 4
+#define SIM_ADC_CLOCK_HZ 48000000u
+
+static struct {
+    float clkdiv;
+    bool fifo_en, irq_en, running;
+    uint8_t thresh;
+    uint16_t fifo[SIM_ADC_FIFO_DEPTH];
+    uint8_t level;
+    uint32_t generation;   // Invalida o evento agendado quando a conversão é parada
+} sim_adc = { .thresh = 1 };
+
+static uint64_t sim_adc_sample_us(void) {
+    // Uma conversão leva no mínimo 96 ciclos; o divisor só pode alongar o intervalo
+    float cycles = sim_adc.clkdiv + 1 < 96 ? 96 : sim_adc.clkdiv + 1;
+    uint64_t us = (uint64_t) (cycles * 1e6f / SIM_ADC_CLOCK_HZ);
+    return us ? us : 1;
+}
+
+static void sim_adc_convert(void *user_data) {
+    if ((uint32_t) (uintptr_t) user_data != sim_adc.generation || !sim_adc.running)
+        return;
+
+    for (uint i = 0; i < sim_adc.thresh && sim_adc.fifo_en && sim_adc.level < SIM_ADC_FIFO_DEPTH; ++i)
+        sim_adc.fifo[sim_adc.level++] = sim_adc_value[sim_adc_input];
+    if (sim_adc.irq_en && sim_adc.level >= sim_adc.thresh)
+        sim_raise_irq(ADC_IRQ_FIFO);
+
+    sim_schedule(sim_now_us + sim_adc_sample_us() * sim_adc.thresh, sim_adc_convert, user_data);
+}
+
+void adc_set_clkdiv(float clkdiv) { sim_adc.clkdiv = clkdiv; }
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+    (void) dreq_en;
+    (void) err_in_fifo;
+    (void) byte_shift;
+    sim_adc.fifo_en = en;
+    sim_adc.thresh = dreq_thresh ? dreq_thresh : 1;
+}
+
+void adc_irq_set_enabled(bool enabled) { sim_adc.irq_en = enabled; }
+
+void adc_run(bool run) {
+    if (run == sim_adc.running)
+        return;
+    sim_adc.running = run;
+    sim_adc.generation++;
+    if (run)
+        sim_schedule(sim_now_us + sim_adc_sample_us() * sim_adc.thresh, sim_adc_convert,
+                     (void *) (uintptr_t) sim_adc.generation);
+}
+
+bool adc_fifo_is_empty(void) { return !sim_adc.level; }
+uint8_t adc_fifo_get_level(void) { return sim_adc.level; }
+
+uint16_t adc_fifo_get(void) {
+    if (!sim_adc.level)
+        return 0;
+    uint16_t value = sim_adc.fifo[0];
+    memmove(sim_adc.fifo, sim_adc.fifo + 1, --sim_adc.level * sizeof(sim_adc.fifo[0]));
+    return value;
+}
+
+void adc_fifo_drain(void) { sim_adc.level = 0; }
+
+// ---------------------------------------------------------------------------
+// PWM e relógios
+
+#define SIM_CLK_SYS_HZ 125000000u
+
+static uint32_t sim_clock_hz[CLK_COUNT] = {
+    [clk_ref] = 12000000u, [clk_sys] = SIM_CLK_SYS_HZ, [clk_peri] = 125000000u,
+    [clk_usb] = 48000000u, [clk_adc] = 48000000u, [clk_rtc] = 46875u,
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index) {
+    return sim_clock_hz[clk_index];
+}
+
+static bool sim_i2c_busy(void);
+
+// Só registra a nova frequência: o relógio virtual não depende dela. O I2C é medido pelo clk_sys, então
+// reduzi-lo com uma transferência no barramento é contado como erro.
+bool clock_configure(enum clock_index clk_index, uint32_t src, uint32_t auxsrc, uint32_t src_freq, uint32_t freq) {
+    (void) src;
+    (void) auxsrc;
+    if (freq > src_freq)
+        return false;
+    if (clk_index == clk_sys && freq < SIM_CLK_SYS_HZ && sim_i2c_busy())
+        sim_stats.i2c_slow++;
+    sim_clock_hz[clk_index] = freq;
+    return true;
+}
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) { (void) slice_num; (void) integer; (void) fract; }
+void pwm_set_wrap(uint slice_num, uint16_t wrap) { (void) slice_num; (void) wrap; }
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) { (void) slice_num; (void) chan; (void) level; }
+void pwm_set_enabled(uint slice_num, bool enabled) { (void) slice_num; (void) enabled; }
+
+// ---------------------------------------------------------------------------
+// Painel SSD1306: decodifica o fluxo de controle/comando/dados e mantém a GDDRAM. Um SH1106 se identifica
+// pelo controle do conversor DC-DC (0xAD), que a sequência do SSD1306 não usa; a partir daí a RAM tem 132
+// colunas com o painel a partir da coluna 2, e só o endereçamento por página existe. O controle da bomba
+// de carga (0x8D) volta ao SSD1306.
+
+#define SIM_SH1106_COLUMNS 132
+#define SIM_SH1106_OFFSET 2
+
+static struct {
+    uint8_t gddram[SIM_SH1106_COLUMNS * SIM_PANEL_PAGES];
+    uint8_t columns, offset;      // Colunas da RAM e primeira coluna visível
+    uint8_t rows;                 // Linhas do painel (SET_MUX_RATIO + 1)
+    uint8_t mode;                 // 0 horizontal, 1 vertical, 2 página
+    uint8_t col, page;
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t command, params[8], nparams, expected;
+    bool expect_control, data_mode, single;
+    bool in_transaction;
+    bool display_on;
+    uint8_t contrast;
+    uint64_t since_us;            // Início do estado atual de display_on / contrast
+    uint8_t start_line;           // Linha da GDDRAM mostrada no topo (SET_DISP_START_LINE)
+    bool inverted;                // Vídeo inverso (SET_NORM_INV)
+    bool scrolling;               // Rolagem contínua ativa; a imagem mostra a GDDRAM parada
+} sim_panel = {
+    .columns = SIM_PANEL_WIDTH, .rows = SIM_PANEL_PAGES * 8,
+    .mode = 2, .col_end = SIM_PANEL_WIDTH - 1, .page_end = SIM_PANEL_PAGES - 1, .contrast = 0x7F,
+};
+
+// Acumula o tempo do painel no estado atual antes de uma mudança
+static void sim_panel_account(void) {
+    uint64_t elapsed = sim_now_us - sim_panel.since_us;
+    if (!sim_panel.display_on)
+        sim_stats.panel_off_us += elapsed;
+    else if (sim_panel.contrast < 0x80)
+        sim_stats.panel_dim_us += elapsed;
+    sim_panel.since_us = sim_now_us;
+}
+
+static uint8_t sim_command_params(uint8_t command) {
+    switch (command) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xAD: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x26: case 0x27:
+        return 6;
+    default:
+        return 0;
+    }
+}
+
+static void sim_command_execute(void) {
+    uint8_t *p = sim_panel.params;
+    switch (sim_panel.command) {
+    case 0x20:
+        sim_panel.mode = p[0] & 0b11;
+        break;
+    case 0x21:
+        sim_panel.col_start = sim_panel.col = p[0] % sim_panel.columns;
+        sim_panel.col_end = p[1] % sim_panel.columns;
+        break;
+    case 0x22:
+        sim_panel.page_start = sim_panel.page = p[0] % SIM_PANEL_PAGES;
+        sim_panel.page_end = p[1] % SIM_PANEL_PAGES;
+        break;
+    case 0x81:
+        sim_panel_account();
+        sim_panel.contrast = p[0];
+        break;
+    case 0x8D:
+        sim_panel.columns = SIM_PANEL_WIDTH;
+        sim_panel.offset = 0;
+        break;
+    case 0xAD:
+        sim_panel.columns = SIM_SH1106_COLUMNS;
+        sim_panel.offset = SIM_SH1106_OFFSET;
+        sim_panel.mode = 2;
+        break;
+    case 0xA8:
+        sim_panel.rows = (p[0] & 0x3F) + 1;
+        break;
+    case 0xAE:
+    case 0xAF:
+        sim_panel_account();
+        sim_panel.display_on = sim_panel.command & 1;
+        break;
+    case 0xA6:
+    case 0xA7:
+        sim_panel.inverted = sim_panel.command & 1;
+        break;
+    case 0x2E:
+    case 0x2F:
+        sim_panel.scrolling = sim_panel.command & 1;
+        break;
+    default:
+        if (sim_panel.command >= 0xB0 && sim_panel.command <= 0xB7)
+            sim_panel.page = sim_panel.command & 0x07;
+        else if (sim_panel.command <= 0x0F)
+            sim_panel.col = (sim_panel.col & 0xF0) | sim_panel.command;
+        else if (sim_panel.command <= 0x1F)
+            sim_panel.col = (sim_panel.col & 0x0F) | ((sim_panel.command & 0x0F) << 4);
+        else if (sim_panel.command >= 0x40 && sim_panel.command <= 0x7F)
+            sim_panel.start_line = sim_panel.command & 0x3F;
+        break;
+    }
+}
+
+static void sim_panel_command(uint8_t byte) {
+    if (sim_panel.nparams < sim_panel.expected) {
+        sim_panel.params[sim_panel.nparams++] = byte;
+    } else {
+        sim_panel.command = byte;
+        sim_panel.nparams = 0;
+        sim_panel.expected = sim_command_params(byte);
+    }
+    if (sim_panel.nparams == sim_panel.expected)
+        sim_command_execute();
+}
+
+static void sim_panel_data(uint8_t byte) {
+    // No controlador o resultado é indefinido; aqui a escrita vale, mas o programa está errado
+    static bool scroll_warned;
+    if (sim_panel.scrolling && !scroll_warned) {
+        fprintf(stderr, "[sim] escrita na GDDRAM com a rolagem ativa\n");
+        scroll_warned = true;
+    }
+    sim_panel.gddram[(sim_panel.col % sim_panel.columns) * SIM_PANEL_PAGES + sim_panel.page % SIM_PANEL_PAGES] = byte;
+    sim_stats.data_bytes++;
+
+    switch (sim_panel.mode) {
+    case 0: // horizontal
+        if (sim_panel.col++ >= sim_panel.col_end) {
+            sim_panel.col = sim_panel.col_start;
+            sim_panel.page = sim_panel.page >= sim_panel.page_end ? sim_panel.page_start : sim_panel.page + 1;
+        }
+        break;
+    case 1: // vertical
+        if (sim_panel.page++ >= sim_panel.page_end) {
+            sim_panel.page = sim_panel.page_start;
+            sim_panel.col = sim_panel.col >= sim_panel.col_end ? sim_panel.col_start : sim_panel.col + 1;
+        }
+        break;
+    default: // página
+        sim_panel.col = (sim_panel.col + 1) % sim_panel.columns;
+        break;
+    }
+}
+
+static void sim_i2c_byte(uint8_t byte, bool stop) {
+    if (!sim_panel.in_transaction) {
+        sim_panel.in_transaction = true;
+        sim_panel.expect_control = true;
+        sim_stats.i2c_transactions++;
+    }
+    sim_stats.i2c_bytes++;
+
+    if (sim_panel.expect_control) {
+        sim_panel.single = byte & 0x80;
+        sim_panel.data_mode = byte & 0x40;
+        sim_panel.expect_control = false;
+    } else {
+        if (sim_panel.data_mode)
+            sim_panel_data(byte);
+        else
+            sim_panel_command(byte);
+        // Com Co = 1 cada byte de comando/dado é seguido de um novo byte de controle
+        if (sim_panel.single)
+            sim_panel.expect_control = true;
+    }
+
+    if (stop)
+        sim_panel.in_transaction = false;
+}
+
+const uint8_t *sim_gddram(void) {
+    return sim_panel.gddram;
+}
+
+// Pixel visível: a linha inicial desloca a GDDRAM na tela e o vídeo inverso troca aceso e apagado
+bool sim_pixel(uint x, uint y) {
+    x += sim_panel.offset;
+    y = (y + sim_panel.start_line) % (SIM_PANEL_PAGES * 8);
+    bool lit = sim_panel.gddram[x * SIM_PANEL_PAGES + (y >> 3)] & (1u << (y & 7));
+    return lit != sim_panel.inverted;
+}
+
+bool sim_dump_pbm(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return false;
+    fprintf(f, "P1\n%d %d\n", SIM_PANEL_WIDTH, sim_panel.rows);
+    for (uint y = 0; y < sim_panel.rows; ++y) {
+        for (uint x = 0; x < SIM_PANEL_WIDTH; ++x)
+            fputc(sim_pixel(x, y) ? '1' : '0', f);
+        fputc('\n', f);
+    }
+    fclose(f);
+    return true;
+}
+
+// Duas linhas de pixels por linha de texto
+void sim_print_ascii(FILE *out) {
+    for (uint y = 0; y < sim_panel.rows; y += 2) {
+        for (uint x = 0; x < SIM_PANEL_WIDTH; ++x) {
+            bool top = sim_pixel(x, y), bottom = sim_pixel(x, y + 1);
+            fputc(top && bottom ? '#' : top ? '"' : bottom ? '.' : ' ', out);
+        }
+        fputc('\n', out);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// I2C
+
+static i2c_hw_t sim_i2c_hw[2] = {
+    { .status = I2C_IC_STATUS_TFE_BITS },
+    { .status = I2C_IC_STATUS_TFE_BITS },
+};
+i2c_inst_t i2c0_inst = { &sim_i2c_hw[0], 100000 };
+i2c_inst_t i2c1_inst = { &sim_i2c_hw[1], 100000 };
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+// 9 bits por byte (8 de dados + ACK)
+static uint64_t sim_i2c_time_us(i2c_inst_t *i2c, size_t bytes) {
+    return (uint64_t) bytes * 9 * 1000000 / i2c->baudrate;
+}
+
+// A escrita bloqueante ocupa o processador pelo tempo de barramento, sem disparar eventos no meio
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    i2c->hw->tar = addr;
+    if (sim_clock_hz[clk_sys] < SIM_CLK_SYS_HZ)
+        sim_stats.i2c_slow++;
+    for (size_t i = 0; i < len; ++i)
+        sim_i2c_byte(src[i], !nostop && i == len - 1);
+
+    uint64_t busy = sim_i2c_time_us(i2c, len + 1);
+    sim_stats.i2c_busy_us += busy;
+    sim_now_us += busy;
+    return (int) len;
+}
+
+// ---------------------------------------------------------------------------
+// DMA
+
+static struct {
+    bool claimed, busy, irq0_enabled, irq0_status;
+    enum dma_channel_transfer_size size;
+    volatile void *write_addr;
+} sim_dma[NUM_DMA_CHANNELS];
+
+int dma_claim_unused_channel(bool required) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+        if (!sim_dma[ch].claimed) {
+            sim_dma[ch].claimed = true;
+            return ch;
+        }
+    }
+    if (required)
+        abort();
+    return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+    sim_dma[channel].claimed = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void) channel;
+    dma_channel_config c = { DMA_SIZE_32 };
+    return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { c->ctrl = size; }
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void) c; (void) incr; }
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void) c; (void) incr; }
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) { (void) c; (void) dreq; }
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+    sim_dma[channel].size = config->ctrl;
+    sim_dma[channel].write_addr = write_addr;
+    if (trigger)
+        dma_channel_transfer_from_buffer_now(channel, read_addr, transfer_count);
+}
+
+static void sim_dma_done(void *user_data) {
+    uint ch = (uint) (uintptr_t) user_data;
+    sim_dma[ch].busy = false;
+    sim_dma[ch].irq0_status = true;
+    if (sim_dma[ch].irq0_enabled)
+        sim_raise_irq(DMA_IRQ_0);
+}
+
+// Transferências para IC_DATA_CMD vão ao decodificador do painel; a conclusão é agendada
+// para quando o último byte sairia no barramento.
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+    i2c_inst_t *i2c = NULL;
+    for (uint i = 0; i < 2; ++i)
+        if (sim_dma[channel].write_addr == &sim_i2c_hw[i].data_cmd)
+            i2c = i ? i2c1 : i2c0;
+
+    uint64_t duration = 0;
+    if (i2c) {
+        if (sim_clock_hz[clk_sys] < SIM_CLK_SYS_HZ)
+            sim_stats.i2c_slow++;
+        uint32_t transactions = 0;
+        for (uint32_t i = 0; i < transfer_count; ++i) {
+            uint32_t word;
+            switch (sim_dma[channel].size) {
+            case DMA_SIZE_8: word = ((const volatile uint8_t *) read_addr)[i]; break;
+            case DMA_SIZE_16: word = ((const volatile uint16_t *) read_addr)[i]; break;
+            default: word = ((const volatile uint32_t *) read_addr)[i]; break;
+            }
+            bool stop = word & I2C_IC_DATA_CMD_STOP_BITS;
+            sim_i2c_byte(word & 0xFF, stop);
+            transactions += stop;
+        }
+        duration = sim_i2c_time_us(i2c, transfer_count + transactions);
+        sim_stats.i2c_busy_us += duration;
+    }
+
+    sim_dma[channel].busy = true;
+    sim_schedule(sim_now_us + duration, sim_dma_done, (void *) (uintptr_t) channel);
+}
+
+bool dma_channel_is_busy(uint channel) { return sim_dma[channel].busy; }
+
+static bool sim_i2c_busy(void) {
+    for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch)
+        if (sim_dma[ch].busy && (sim_dma[ch].write_addr == &sim_i2c_hw[0].data_cmd ||
+                                 sim_dma[ch].write_addr == &sim_i2c_hw[1].data_cmd))
+            return true;
+    return false;
+}
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) { sim_dma[channel].irq0_enabled = enabled; }
+bool dma_channel_get_irq0_status(uint channel) { return sim_dma[channel].irq0_status; }
+void dma_channel_acknowledge_irq0(uint channel) { sim_dma[channel].irq0_status = false; }
+
+// ---------------------------------------------------------------------------
+// Flash (hardware/flash.h)
+
+// Tempos típicos de uma W25Q16: o processador fica parado e as interrupções esperam
+#define SIM_FLASH_ERASE_US 45000
+#define SIM_FLASH_PAGE_US 700
+#define SIM_FLASH_SECTORS (PICO_FLASH_SIZE_BYTES / FLASH_SECTOR_SIZE)
+
+static uint8_t *sim_flash;
+static uint32_t sim_flash_erases[SIM_FLASH_SECTORS];
+
+// Mapeia a imagem na primeira leitura ou escrita; sem arquivo, a flash começa apagada a cada execução.
+const uint8_t *sim_flash_xip(void) {
+    if (sim_flash)
+        return sim_flash;
+
+    const char *path = getenv("POMODORO_SIM_FLASH");
+    if (path) {
+        int fd = open(path, O_RDWR | O_CREAT, 0644);
+        off_t size = fd < 0 ? -1 : lseek(fd, 0, SEEK_END);
+        if (fd < 0 || size < 0) {
+            fprintf(stderr, "[sim] falha ao abrir %s\n", path);
+            exit(2);
+        }
+        if (size < PICO_FLASH_SIZE_BYTES) {
+            // Completa a imagem com bytes apagados
+            static const uint8_t erased[FLASH_SECTOR_SIZE] = { [0 ... FLASH_SECTOR_SIZE - 1] = 0xFF };
+            for (off_t at = size; at < PICO_FLASH_SIZE_BYTES; ) {
+                size_t n = FLASH_SECTOR_SIZE - at % FLASH_SECTOR_SIZE;
+                if (pwrite(fd, erased, n, at) != (ssize_t) n)
+                    break;
+                at += n;
+            }
+        }
+        sim_flash = mmap(NULL, PICO_FLASH_SIZE_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (sim_flash == MAP_FAILED) {
+            fprintf(stderr, "[sim] falha ao mapear %s\n", path);
+            exit(2);
+        }
+    } else {
+        sim_flash = malloc(PICO_FLASH_SIZE_BYTES);
+        memset(sim_flash, 0xFF, PICO_FLASH_SIZE_BYTES);
+    }
+    return sim_flash;
+}
+
+static void sim_flash_check(uint32_t offs, size_t count, uint32_t align) {
+    if (offs % align || count % align || offs + count > PICO_FLASH_SIZE_BYTES) {
+        fprintf(stderr, "[sim] acesso a flash invalido: 0x%06x, %zu bytes\n", (unsigned) offs, count);
+        abort();
+    }
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    sim_flash_check(flash_offs, count, FLASH_SECTOR_SIZE);
+    sim_flash_xip();
+    memset(sim_flash + flash_offs, 0xFF, count);
+    for (uint32_t s = flash_offs / FLASH_SECTOR_SIZE; s < (flash_offs + count) / FLASH_SECTOR_SIZE; ++s) {
+        sim_flash_erases[s]++;
+        sim_stats.flash_erases++;
+        sim_stats.flash_busy_us += SIM_FLASH_ERASE_US;
+        sim_now_us += SIM_FLASH_ERASE_US;
+    }
+}
+
+// Como na NOR, a gravação só limpa bits: gravar sobre dados sem apagar antes corrompe o conteúdo
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count) {
+    sim_flash_check(flash_offs, count, FLASH_PAGE_SIZE);
+    sim_flash_xip();
+    for (size_t i = 0; i < count; ++i)
+        sim_flash[flash_offs + i] &= data[i];
+    sim_stats.flash_pages += count / FLASH_PAGE_SIZE;
+    sim_stats.flash_busy_us += count / FLASH_PAGE_SIZE * SIM_FLASH_PAGE_US;
+    sim_now_us += count / FLASH_PAGE_SIZE * SIM_FLASH_PAGE_US;
+}
+
+uint32_t sim_flash_sector_erases(uint sector) {
+    return sector < SIM_FLASH_SECTORS ? sim_flash_erases[sector] : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Porta serial da USB CDC (pico/stdio_usb.h)
+
+#define SIM_USB_PACKET 64
+#define SIM_SERIAL_CAPTURE 4096
+
+static FILE *sim_serial_file;
+static uint8_t sim_serial_capture[SIM_SERIAL_CAPTURE];
+static size_t sim_serial_head, sim_serial_tail;
+
+// Cada escrita do driver é enviada em seguida, em pacotes bulk de até 64 bytes. A captura guarda os
+// últimos SIM_SERIAL_CAPTURE bytes ainda não lidos.
+static void sim_usb_out_chars(const char *buf, int len) {
+    sim_stats.usb_bytes += len;
+    sim_stats.usb_packets += (len + SIM_USB_PACKET - 1) / SIM_USB_PACKET;
+    if (sim_serial_file)
+        fwrite(buf, 1, len, sim_serial_file);
+    for (int i = 0; i < len; ++i) {
+        sim_serial_capture[sim_serial_head++ % SIM_SERIAL_CAPTURE] = buf[i];
+        if (sim_serial_head - sim_serial_tail > SIM_SERIAL_CAPTURE)
+            sim_serial_tail++;
+    }
+}
+
+static void sim_usb_out_flush(void) {
+    if (sim_serial_file)
+        fflush(sim_serial_file);
+}
+
+static int sim_usb_in_chars(char *buf, int len) {
+    (void) buf;
+    (void) len;
+    return PICO_ERROR_TIMEOUT;
+}
+
+stdio_driver_t stdio_usb = {
+    .out_chars = sim_usb_out_chars,
+    .out_flush = sim_usb_out_flush,
+    .in_chars = sim_usb_in_chars,
+};
+
+bool stdio_usb_connected(void) {
+    return true;
+}
+
+size_t sim_serial_read(uint8_t *out, size_t max) {
+    size_t n = 0;
+    while (n < max && sim_serial_tail != sim_serial_head)
+        out[n++] = sim_serial_capture[sim_serial_tail++ % SIM_SERIAL_CAPTURE];
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// Roteiro de entradas, fim da simulação e resumo
+
+static void sim_joystick_release(void *user_data) {
+    (void) user_data;
+    sim_set_adc(SIM_JOYSTICK_INPUT, 2048);
+}
+
+static void sim_script_action(void *user_data) {
+    switch ((char) (uintptr_t) user_data) {
+    case 'B':
+        sim_press_button(SIM_BUTTON_B, 80);
+        break;
+    case 'R':
+    case 'L':
+        sim_set_adc(SIM_JOYSTICK_INPUT, (char) (uintptr_t) user_data == 'R' ? 4095 : 0);
+        sim_schedule(sim_now_us + 250000, sim_joystick_release, NULL);
+        break;
+    case 'P':
+    case 'T':
+        if (sim_stdin_head - sim_stdin_tail < sizeof(sim_stdin))
+            sim_stdin[sim_stdin_head++ % sizeof(sim_stdin)] = (char) (uintptr_t) user_data - 'A' + 'a';
+        break;
+    case 'S':
+        printf("[sim] tela em %llu ms\n", (unsigned long long) (sim_now_us / 1000));
+        sim_print_ascii(stdout);
+        break;
+    }
+}
+
+static void sim_finish(void *user_data) {
+    (void) user_data;
+    struct timespec wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall_ms = (wall_end.tv_sec - sim_wall_start.tv_sec) * 1e3 + (wall_end.tv_nsec - sim_wall_start.tv_nsec) / 1e6;
+
+    sim_print_ascii(stdout);
+    printf("[sim] %.1f min virtuais em %.1f ms reais\n", sim_now_us / 60e6, wall_ms);
+    printf("[sim] I2C: %llu transacoes, %llu bytes, barramento ocupado %.1f ms; GDDRAM: %llu bytes; despertares: %llu\n",
+           (unsigned long long) sim_stats.i2c_transactions, (unsigned long long) sim_stats.i2c_bytes,
+           sim_stats.i2c_busy_us / 1e3, (unsigned long long) sim_stats.data_bytes,
+           (unsigned long long) sim_stats.wakeups);
+    if (sim_stats.i2c_slow)
+        printf("[sim] AVISO: %llu transferencias I2C com o clk_sys reduzido\n", (unsigned long long) sim_stats.i2c_slow);
+    sim_panel_account();
+    printf("[sim] painel: apagado %.1f%%, com contraste reduzido %.1f%% do tempo\n",
+           sim_now_us ? sim_stats.panel_off_us * 100.0 / sim_now_us : 0.0,
+           sim_now_us ? sim_stats.panel_dim_us * 100.0 / sim_now_us : 0.0);
+    if (sim_stats.flash_erases || sim_stats.flash_pages) {
+        uint32_t wear_max = 0;
+        for (uint s = 0; s < SIM_FLASH_SECTORS; ++s)
+            if (sim_flash_erases[s] > wear_max)
+                wear_max = sim_flash_erases[s];
+        printf("[sim] flash: %llu paginas gravadas, %llu setores apagados (max %lu por setor), ocupada %.1f ms\n",
+               (unsigned long long) sim_stats.flash_pages, (unsigned long long) sim_stats.flash_erases,
+               (unsigned long) wear_max, sim_stats.flash_busy_us / 1e3);
+    }
+
+    if (sim_stats.usb_bytes) {
+        printf("[sim] USB: %llu bytes em %llu pacotes\n",
+               (unsigned long long) sim_stats.usb_bytes, (unsigned long long) sim_stats.usb_packets);
+    }
+    if (sim_serial_file)
+        fclose(sim_serial_file);
+
+    if (sim_dump_path && !sim_dump_pbm(sim_dump_path))
+        fprintf(stderr, "[sim] falha ao gravar %s\n", sim_dump_path);
+    exit(0);
+}
+
+const sim_stats_t *sim_get_stats(void) {
+    return &sim_stats;
+}
+
+// Lê o roteiro e agenda as entradas e o fim da simulação. Programas que só usam o simulador
+// como biblioteca (benchmarks) não chamam stdio_init_all e não recebem roteiro nem fim.
+static void sim_setup(void) {
+    static bool done;
+    if (done)
+        return;
+    done = true;
+    clock_gettime(CLOCK_MONOTONIC, &sim_wall_start);
+
+    const char *script = getenv("POMODORO_SIM_SCRIPT");
+    if (!script)
+        script = SIM_DEFAULT_SCRIPT;
+    const char *end = getenv("POMODORO_SIM_END_MS");
+    sim_dump_path = getenv("POMODORO_SIM_DUMP");
+    const char *jitter = getenv("POMODORO_SIM_ALARM_JITTER_US");
+    if (jitter)
+        sim_alarm_jitter_us = strtoul(jitter, NULL, 10);
+    const char *serial = getenv("POMODORO_SIM_SERIAL");
+    if (serial && !(sim_serial_file = fopen(serial, "wb"))) {
+        fprintf(stderr, "[sim] falha ao abrir %s\n", serial);
+        exit(2);
+    }
+
+    for (const char *p = script; *p; ) {
+        char *colon;
+        unsigned long ms = strtoul(p, &colon, 10);
+        if (*colon != ':' || !colon[1]) {
+            fprintf(stderr, "[sim] roteiro invalido perto de \"%s\"\n", p);
+            exit(2);
+        }
+        sim_schedule((uint64_t) ms * 1000, sim_script_action, (void *) (uintptr_t) colon[1]);
+        p = colon + 2;
+        if (*p == ',')
+            p++;
+    }
+
+    sim_schedule((uint64_t) (end ? strtoull(end, NULL, 10) : SIM_DEFAULT_END_MS) * 1000, sim_finish, NULL);
+}
@@ -0,0 +1,44 @@
+#ifndef _POMODORO_SIM_H
+#define _POMODORO_SIM_H
+
+// Controle do simulador de host: relógio virtual, entradas roteirizadas e a imagem do display
+// reconstruída a partir do tráfego I2C.
+
+#include <stdio.h>
+#include "pico/types.h"
+
+#define SIM_PANEL_WIDTH 128
+#define SIM_PANEL_PAGES 8
+
+typedef struct {
+    uint64_t i2c_bytes;         // Bytes escritos no barramento, sem contar o byte de endereço
+    uint64_t i2c_transactions;  // Transações (START ... STOP)
+    uint64_t i2c_busy_us;       // Tempo de barramento ocupado, pelo baud configurado
+    uint64_t data_bytes;        // Bytes gravados na GDDRAM
+    uint64_t wakeups;           // Vezes em que o programa dormiu e foi acordado por um evento
+    uint64_t flash_pages;       // Páginas gravadas na flash
+    uint64_t flash_erases;      // Setores apagados
+    uint64_t flash_busy_us;     // Tempo parado em operações de flash
+    uint64_t panel_off_us;      // Tempo com o painel desligado (SET_DISP) ou ainda não ligado
+    uint64_t panel_dim_us;      // Tempo ligado com contraste abaixo de 0x80
+    uint64_t usb_bytes;         // Bytes escritos na porta serial da USB pelo driver (sem o printf)
+    uint64_t usb_packets;       // Pacotes bulk de até 64 bytes
+    uint64_t i2c_slow;          // Transferências I2C com o clk_sys reduzido (o baud cai junto com ele)
+} sim_stats_t;
+
+typedef void (*sim_event_fn_t)(void *user_data);
+
+void sim_schedule(uint64_t at_us, sim_event_fn_t fn, void *user_data);
+void sim_advance(uint64_t us);
+void sim_press_button(uint gpio, uint32_t hold_ms);
+void sim_set_adc(uint input, uint16_t value);
+
+const sim_stats_t *sim_get_stats(void);
+const uint8_t *sim_gddram(void);  // [coluna da RAM * SIM_PANEL_PAGES + página], como o buffer do driver
+bool sim_pixel(uint x, uint y);   // Como aparece no painel: com linha inicial e vídeo inverso
+bool sim_dump_pbm(const char *path);
+void sim_print_ascii(FILE *out);
+uint32_t sim_flash_sector_erases(uint sector);  // Apagamentos do setor nesta execução, para medir o desgaste
+size_t sim_serial_read(uint8_t *out, size_t max);  // Consome os bytes capturados da porta serial da USB
+
+#endif
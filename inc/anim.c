@@ -0,0 +1,93 @@
+#include "anim.h"
+#include "hardware/sync.h"
+
+static uint8_t anim_wipe_step;        // Próximo passo da cortina, a partir de 1; 0 sem cortina
+static uint64_t anim_wipe_at_us;
+static uint8_t anim_flash_left;       // Trocas de vídeo inverso que faltam
+static bool anim_inverted;
+static uint64_t anim_flash_at_us;
+static alarm_id_t anim_alarm;
+
+// O alarme só tira o laço do __wfi (ou, com o display no núcleo 1, do __wfe dele); o passo é dado por
+// anim_service.
+static int64_t anim_wake(alarm_id_t id, void *user_data) {
+  anim_alarm = 0;
+  __sev();
+  return 0;
+}
+
+static uint64_t anim_deadline(void) {
+  if (!anim_wipe_step)
+    return anim_flash_at_us;
+  if (!anim_flash_left)
+    return anim_wipe_at_us;
+  return anim_wipe_at_us < anim_flash_at_us ? anim_wipe_at_us : anim_flash_at_us;
+}
+
+// Começa a cortina com o conteúdo atual do buffer. Retorna false, e o quadro segue pelo envio comum,
+// se o conteúdo da GDDRAM ainda é desconhecido.
+bool anim_wipe(ssd1306_t *ssd) {
+  if (!ssd->shadow_valid)
+    return false;
+  anim_wipe_step = 1;
+  anim_wipe_at_us = time_us_64();
+  return true;
+}
+
+// Pisca o painel `count` vezes em vídeo inverso. Uma piscada em curso é estendida, não reiniciada.
+void anim_flash(uint8_t count) {
+  if (!anim_flash_left)
+    anim_flash_at_us = time_us_64();
+  anim_flash_left = 2 * count + anim_inverted;
+}
+
+// Dá os passos vencidos. Um passo que não cabe nos buffers do DMA fica para a próxima chamada.
+void anim_service(ssd1306_t *ssd) {
+  uint64_t now = time_us_64();
+
+  if (anim_flash_left && now >= anim_flash_at_us) {
+    uint8_t command = SET_NORM_INV | !anim_inverted;
+    if (ssd1306_send_commands_async(ssd, &command, 1)) {
+      anim_inverted = !anim_inverted;
+      anim_flash_left--;
+      anim_flash_at_us = now + ANIM_FLASH_STEP_US;
+    }
+  }
+
+  if (anim_wipe_step && now >= anim_wipe_at_us) {
+    uint8_t command = SET_DISP_START_LINE | (anim_wipe_step * 8 % ssd->height);
+    if (ssd1306_send_page_async(ssd, anim_wipe_step - 1, &command, 1)) {
+      anim_wipe_step = anim_wipe_step < ssd->pages ? anim_wipe_step + 1 : 0;
+      anim_wipe_at_us = now + ANIM_WIPE_STEP_US;
+    }
+  }
+
+  if (anim_alarm)
+    cancel_alarm(anim_alarm);
+  anim_alarm = anim_running() ? add_alarm_at(anim_deadline(), anim_wake, NULL, true) : 0;
+  if (anim_alarm < 0)
+    anim_alarm = 0;
+}
+
+// A cortina está deslocando a tela: envios comuns devem esperar.
+bool anim_busy(void) {
+  return anim_wipe_step;
+}
+
+bool anim_running(void) {
+  return anim_wipe_step || anim_flash_left;
+}
+
+// Há um passo vencido esperando anim_service.
+bool anim_due(void) {
+  return anim_running() && time_us_64() >= anim_deadline();
+}
+
+// Microssegundos até o próximo passo, 0 se já venceu.
+uint32_t anim_wait_us(void) {
+  if (!anim_running())
+    return 0;
+  uint64_t now = time_us_64();
+  uint64_t deadline = anim_deadline();
+  return deadline > now ? (uint32_t) (deadline - now) : 0;
+}
@@ -0,0 +1,33 @@
+#ifndef ANIM_H
+#define ANIM_H
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+// Animações feitas pelo controlador do display, sem reenviar quadros.
+//
+// Cortina (anim_wipe): a tela nova, já desenhada no buffer, sobe por baixo da que está no painel. A cada
+// passo a linha inicial do display (SET_DISP_START_LINE) desce 8 linhas, e a página da GDDRAM que acabou
+// de passar do topo para a base recebe a página correspondente da tela nova, só as colunas que mudaram.
+// Depois de uma página por passo a linha inicial volta a 0 e a GDDRAM guarda a tela nova na posição
+// normal. Cada passo custa os comandos de um endereçamento mais o que mudou naquela página, e não um
+// quadro inteiro; somando os passos, o mesmo que um envio comum da troca de tela mais uns 2 bytes por página.
+// Enquanto a cortina anda os envios comuns esperam (anim_busy), porque a posição das páginas na tela
+// está deslocada; o que for desenhado nesse meio tempo segue no próximo envio.
+//
+// Piscada (anim_flash): o painel alterna para vídeo inverso (SET_NORM_INV) e volta, 2 bytes por troca.
+//
+// Quem é dono do display chama anim_service no seu laço; um alarme acorda o laço no prazo de cada passo.
+
+#define ANIM_WIPE_STEP_US 30000     // 8 páginas: a cortina inteira leva 240 ms
+#define ANIM_FLASH_STEP_US 150000
+
+bool anim_wipe(ssd1306_t *ssd);
+void anim_flash(uint8_t count);
+void anim_service(ssd1306_t *ssd);
+bool anim_busy(void);
+bool anim_running(void);
+bool anim_due(void);
+uint32_t anim_wait_us(void);
+
+#endif
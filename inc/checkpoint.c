@@ -0,0 +1,141 @@
+#include <stddef.h>
+#include <string.h>
+#include "checkpoint.h"
+#include "history.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+
+#define CHECKPOINT_OFFSET (PICO_FLASH_SIZE_BYTES - (HISTORY_SECTORS + CHECKPOINT_SECTORS) * FLASH_SECTOR_SIZE)
+#define CHECKPOINT_SLOTS_PER_SECTOR (FLASH_SECTOR_SIZE / CHECKPOINT_SLOT_SIZE)
+#define CHECKPOINT_SLOTS (CHECKPOINT_SECTORS * CHECKPOINT_SLOTS_PER_SECTOR)
+#define CHECKPOINT_MAGIC 0x504F4D31u   // "POM1"
+
+_Static_assert(sizeof(checkpoint_t) <= CHECKPOINT_SLOT_SIZE, "o checkpoint não cabe na posição");
+_Static_assert(CHECKPOINT_SLOT_SIZE % FLASH_PAGE_SIZE == 0, "a posição deve ter páginas inteiras");
+
+// Posição a gravar, já com o conteúdo do próximo checkpoint (o restante fica em 0xFF)
+static union {
+  checkpoint_t checkpoint;
+  uint8_t bytes[CHECKPOINT_SLOT_SIZE];
+} checkpoint_slot;
+
+static uint32_t checkpoint_head;      // Próxima posição do anel
+static uint32_t checkpoint_seq;
+static checkpoint_t checkpoint_last;  // Último gravado, para não regravar o mesmo conteúdo
+static bool checkpoint_has_last;
+static checkpoint_stats_t checkpoint_stats;
+
+static const checkpoint_t *checkpoint_flash_slot(uint32_t slot) {
+  return (const checkpoint_t *) (XIP_BASE + CHECKPOINT_OFFSET + slot * CHECKPOINT_SLOT_SIZE);
+}
+
+static uint32_t checkpoint_crc(const checkpoint_t *c) {
+  const uint8_t *bytes = (const uint8_t *) c + offsetof(checkpoint_t, preset);
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < sizeof(checkpoint_t) - offsetof(checkpoint_t, preset); ++i) {
+    crc ^= bytes[i];
+    for (uint b = 0; b < 8; ++b)
+      crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+  }
+  return ~crc;
+}
+
+static bool checkpoint_valid(const checkpoint_t *c) {
+  return c->magic == CHECKPOINT_MAGIC && c->count <= SESSION_MAX && c->crc == checkpoint_crc(c);
+}
+
+// Procura o checkpoint mais recente. O CRC só é calculado para os candidatos, do mais novo para o mais
+// antigo, até achar um íntegro. Retorna false se não houver nenhum.
+bool checkpoint_init(checkpoint_t *out) {
+  uint32_t tried_below = UINT32_MAX;
+
+  while (true) {
+    const checkpoint_t *best = NULL;
+    uint32_t best_slot = 0;
+    for (uint32_t slot = 0; slot < CHECKPOINT_SLOTS; ++slot) {
+      const checkpoint_t *c = checkpoint_flash_slot(slot);
+      if (c->magic != CHECKPOINT_MAGIC || c->seq >= tried_below)
+        continue;
+      if (!best || c->seq > best->seq) {
+        best = c;
+        best_slot = slot;
+      }
+    }
+
+    if (!best)
+      break;
+    if (checkpoint_valid(best)) {
+      *out = *best;
+      checkpoint_last = *best;
+      checkpoint_has_last = true;
+      checkpoint_head = (best_slot + 1) % CHECKPOINT_SLOTS;
+      checkpoint_seq = best->seq + 1;
+      return true;
+    }
+
+    // Gravação interrompida: o anel continua depois dela, e o anterior é o candidato seguinte
+    if (tried_below == UINT32_MAX) {
+      checkpoint_head = (best_slot + 1) % CHECKPOINT_SLOTS;
+      checkpoint_seq = best->seq + 1;
+    }
+    tried_below = best->seq;
+  }
+  return false;
+}
+
+typedef struct {
+  uint32_t offset;
+  bool erase;
+} checkpoint_op_t;
+
+static void checkpoint_flash_op(void *param) {
+  const checkpoint_op_t *op = param;
+  if (op->erase)
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+  flash_range_program(op->offset, checkpoint_slot.bytes, CHECKPOINT_SLOT_SIZE);
+}
+
+// Grava no laço principal, nunca numa interrupção. Se só o número de sequência mudaria, não grava.
+// Uma posição já usada (gravação interrompida no meio do setor) é pulada até o próximo setor.
+void checkpoint_save(checkpoint_t *checkpoint) {
+  if (checkpoint_has_last && checkpoint->count == checkpoint_last.count &&
+      !memcmp(checkpoint->preset, checkpoint_last.preset, sizeof(checkpoint->preset)) &&
+      !memcmp(checkpoint->sessions, checkpoint_last.sessions, checkpoint->count * sizeof(session_snapshot_t))) {
+    checkpoint_stats.skipped++;
+    return;
+  }
+
+  while (checkpoint_head % CHECKPOINT_SLOTS_PER_SECTOR &&
+         checkpoint_flash_slot(checkpoint_head)->magic != 0xFFFFFFFFu)
+    checkpoint_head = (checkpoint_head + 1) % CHECKPOINT_SLOTS;
+
+  // Sessões além de `count` não são gravadas: ficam apagadas na flash
+  memset(checkpoint_slot.bytes, 0xFF, sizeof(checkpoint_slot.bytes));
+  memcpy(&checkpoint_slot.checkpoint, checkpoint,
+         offsetof(checkpoint_t, sessions) + checkpoint->count * sizeof(session_snapshot_t));
+  checkpoint_slot.checkpoint.magic = CHECKPOINT_MAGIC;
+  checkpoint_slot.checkpoint.seq = checkpoint_seq;
+  checkpoint_slot.checkpoint.crc = checkpoint_crc(&checkpoint_slot.checkpoint);
+
+  checkpoint_op_t op = {
+    .offset = CHECKPOINT_OFFSET + checkpoint_head * CHECKPOINT_SLOT_SIZE,
+    .erase = !(checkpoint_head % CHECKPOINT_SLOTS_PER_SECTOR),
+  };
+  uint64_t start_us = time_us_64();
+  if (flash_safe_execute(checkpoint_flash_op, &op, UINT32_MAX) != PICO_OK)
+    return;
+  uint32_t elapsed = (uint32_t) (time_us_64() - start_us);
+
+  checkpoint_last = checkpoint_slot.checkpoint;
+  checkpoint_has_last = true;
+  checkpoint_head = (checkpoint_head + 1) % CHECKPOINT_SLOTS;
+  checkpoint_seq++;
+  checkpoint_stats.saves++;
+  checkpoint_stats.erases += op.erase;
+  if (elapsed > checkpoint_stats.save_max_us)
+    checkpoint_stats.save_max_us = elapsed;
+}
+
+void checkpoint_get_stats(checkpoint_stats_t *out) {
+  *out = checkpoint_stats;
+}
@@ -0,0 +1,36 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "pico/stdlib.h"
+#include "session.h"
+
+// Checkpoint da última configuração e das sessões em andamento, para retomar depois de um reset.
+//
+// Fica em setores próprios logo abaixo do histórico. Cada checkpoint ocupa uma posição de 512 bytes,
+// gravada em seguida à anterior; só o mais recente com CRC válido vale. Um setor só é apagado quando
+// a gravação chega nele, então uma queda de energia durante a escrita deixa o checkpoint anterior intacto.
+
+#define CHECKPOINT_SECTORS 4
+#define CHECKPOINT_SLOT_SIZE 512
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t crc;                         // CRC-32 dos campos seguintes
+  uint8_t preset[3];                    // Última configuração escolhida no menu
+  uint8_t count;                        // Sessões em andamento
+  session_snapshot_t sessions[SESSION_MAX];
+} checkpoint_t;
+
+typedef struct {
+  uint32_t saves;           // Checkpoints gravados desde o boot
+  uint32_t skipped;         // Pedidos ignorados porque nada mudou
+  uint32_t erases;
+  uint32_t save_max_us;
+} checkpoint_stats_t;
+
+bool checkpoint_init(checkpoint_t *out);
+void checkpoint_save(checkpoint_t *checkpoint);
+void checkpoint_get_stats(checkpoint_stats_t *out);
+
+#endif
@@ -0,0 +1,51 @@
+#include "event.h"
+#include "hardware/sync.h"
+
+void event_ring_init(event_ring_t *ring, event_t *buffer, uint32_t capacity) {
+  ring->buffer = buffer;
+  ring->mask = capacity - 1;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->posted = 0;
+  ring->dropped = 0;
+  ring->peak = 0;
+  ring->batches = 0;
+}
+
+// Lado do produtor. Retorna false se a fila estiver cheia; o evento é descartado e contado.
+bool event_post(event_ring_t *ring, uint8_t type, int8_t arg, uint16_t data) {
+  uint32_t head = ring->head;
+  uint32_t used = head - ring->tail;
+  if (used > ring->mask) {
+    ring->dropped = ring->dropped + 1;
+    return false;
+  }
+
+  ring->buffer[head & ring->mask] = (event_t) { type, arg, data };
+  __dmb(); // A entrada fica visível antes do novo head
+  ring->head = head + 1;
+
+  ring->posted = ring->posted + 1;
+  if (used + 1 > ring->peak)
+    ring->peak = used + 1;
+  return true;
+}
+
+// Lado do consumidor: copia até `max` eventos para `out` e retorna quantos foram lidos.
+uint event_drain(event_ring_t *ring, event_t *out, uint max) {
+  uint32_t tail = ring->tail;
+  uint32_t available = ring->head - tail;
+  if (!available)
+    return 0;
+  __dmb(); // As entradas só são lidas depois de observado o head que as publicou
+
+  if (available > max)
+    available = max;
+  for (uint32_t i = 0; i < available; ++i)
+    out[i] = ring->buffer[(tail + i) & ring->mask];
+
+  __dmb(); // As posições só são devolvidas ao produtor depois de copiadas
+  ring->tail = tail + available;
+  ring->batches++;
+  return available;
+}
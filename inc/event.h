@@ -0,0 +1,45 @@
+#ifndef EVENT_H
+#define EVENT_H
+
+#include "pico/stdlib.h"
+
+// Fila de eventos de capacidade fixa entre um produtor e um consumidor (SPSC), sem travas.
+//
+// O produtor são as interrupções do núcleo 0 (ADC, alarmes, GPIO). Todas têm a mesma prioridade
+// no NVIC, então nunca interrompem umas às outras e se comportam como um único produtor.
+// O consumidor é o laço principal, que esvazia a fila em lotes.
+// Só o produtor escreve `head` e só o consumidor escreve `tail`; as barreiras garantem que uma
+// entrada esteja completa antes de ser publicada e que só seja reaproveitada depois de lida.
+
+typedef enum {
+  EVENT_TICK,       // Um segundo do temporizador. data: 16 bits baixos do número do tick
+  EVENT_BUTTON,     // arg: 1 apertado, 0 solto
+  EVENT_JOYSTICK,   // arg: -1 esquerda, 1 direita. data: 0 no primeiro evento, depois o número da repetição
+} event_type_t;
+
+typedef struct {
+  uint8_t type;     // event_type_t
+  int8_t arg;
+  uint16_t data;
+} event_t;
+
+typedef struct {
+  event_t *buffer;
+  uint32_t mask;              // Capacidade - 1 (a capacidade é potência de 2)
+  volatile uint32_t head;     // Próxima posição a escrever (produtor)
+  volatile uint32_t tail;     // Próxima posição a ler (consumidor)
+  volatile uint32_t posted;   // Eventos aceitos (produtor)
+  volatile uint32_t dropped;  // Eventos descartados com a fila cheia (produtor)
+  volatile uint32_t peak;     // Maior ocupação observada (produtor)
+  uint32_t batches;           // Lotes esvaziados (consumidor)
+} event_ring_t;
+
+void event_ring_init(event_ring_t *ring, event_t *buffer, uint32_t capacity);
+bool event_post(event_ring_t *ring, uint8_t type, int8_t arg, uint16_t data);
+uint event_drain(event_ring_t *ring, event_t *out, uint max);
+
+static inline bool event_pending(const event_ring_t *ring) {
+  return ring->head != ring->tail;
+}
+
+#endif
@@ -1,67 +1,36 @@
-// Fontes para A-Z e 0-9. Os caracteres tem 8x8 pixels
+#ifndef FONT_H
+#define FONT_H
 
-static uint8_t font[] = {
-0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Nothing
-0x3e, 0x41, 0x41, 0x49, 0x41, 0x41, 0x3e, 0x00, //0
-0x00, 0x00, 0x42, 0x7f, 0x40, 0x00, 0x00, 0x00, //1
-0x30, 0x49, 0x49, 0x49, 0x49, 0x46, 0x00, 0x00, //2
-0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00, //3
-0x3f, 0x20, 0x20, 0x78, 0x20, 0x20, 0x00, 0x00, //4
-0x4f, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00, //5
-0x3f, 0x48, 0x48, 0x48, 0x48, 0x48, 0x30, 0x00, //6
-0x01, 0x01, 0x01, 0x61, 0x31, 0x0d, 0x03, 0x00, //7
-0x36, 0x49, 0x49, 0x49, 0x49, 0x49, 0x36, 0x00, //8
-0x06, 0x09, 0x09, 0x09, 0x09, 0x09, 0x7f, 0x00, //9
-0x78, 0x14, 0x12, 0x11, 0x12, 0x14, 0x78, 0x00, //A
-0x7f, 0x49, 0x49, 0x49, 0x49, 0x49, 0x7f, 0x00, //B
-0x7e, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x00, //C
-0x7f, 0x41, 0x41, 0x41, 0x41, 0x41, 0x7e, 0x00, //D
-0x7f, 0x49, 0x49, 0x49, 0x49, 0x49, 0x49, 0x00, //E
-0x7f, 0x09, 0x09, 0x09, 0x09, 0x01, 0x01, 0x00, //F
-0x7f, 0x41, 0x41, 0x41, 0x51, 0x51, 0x73, 0x00, //G
-0x7f, 0x08, 0x08, 0x08, 0x08, 0x08, 0x7f, 0x00, //H
-0x00, 0x00, 0x00, 0x7f, 0x00, 0x00, 0x00, 0x00, //I
-0x21, 0x41, 0x41, 0x3f, 0x01, 0x01, 0x01, 0x00, //J
-0x00, 0x7f, 0x08, 0x08, 0x14, 0x22, 0x41, 0x00, //K
-0x7f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, //L
-0x7f, 0x02, 0x04, 0x08, 0x04, 0x02, 0x7f, 0x00, //M
-0x7f, 0x02, 0x04, 0x08, 0x10, 0x20, 0x7f, 0x00, //N
-0x3e, 0x41, 0x41, 0x41, 0x41, 0x41, 0x3e, 0x00, //O
-0x7f, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, //P
-0x3e, 0x41, 0x41, 0x49, 0x51, 0x61, 0x7e, 0x00, //Q
-0x7f, 0x11, 0x11, 0x11, 0x31, 0x51, 0x0e, 0x00, //R
-0x46, 0x49, 0x49, 0x49, 0x49, 0x30, 0x00, 0x00, //S
-0x01, 0x01, 0x01, 0x7f, 0x01, 0x01, 0x01, 0x00, //T
-0x3f, 0x40, 0x40, 0x40, 0x40, 0x40, 0x3f, 0x00, //U
-0x0f, 0x10, 0x20, 0x40, 0x20, 0x10, 0x0f, 0x00, //V
-0x7f, 0x20, 0x10, 0x08, 0x10, 0x20, 0x7f, 0x00, //W
-0x00, 0x41, 0x22, 0x14, 0x14, 0x22, 0x41, 0x00, //X
-0x01, 0x02, 0x04, 0x78, 0x04, 0x02, 0x01, 0x00, //Y
-0x41, 0x61, 0x59, 0x45, 0x43, 0x41, 0x00, 0x00, //Z
-0x00, 0x20, 0x54, 0x54, 0x54, 0x7C, 0x40, 0x00, // a
-0x7F, 0x48, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, // b
-0x38, 0x44, 0x44, 0x44, 0x44, 0x28, 0x00, 0x00, // c
-0x38, 0x44, 0x44, 0x44, 0x48, 0x7F, 0x00, 0x00, // d
-0x38, 0x54, 0x54, 0x54, 0x54, 0x18, 0x00, 0x00, // e
-0x08, 0x7E, 0x09, 0x01, 0x02, 0x00, 0x00, 0x00, // f
-0x18, 0xA4, 0xA4, 0xA4, 0xA4, 0x7C, 0x00, 0x00, // g
-0x7F, 0x08, 0x04, 0x04, 0x04, 0x78, 0x00, 0x00, // h
-0x00, 0x44, 0x7D, 0x40, 0x00, 0x00, 0x00, 0x00, // i
-0x40, 0x80, 0x84, 0x7D, 0x00, 0x00, 0x00, 0x00, // j
-0x7F, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, 0x00, // k
-0x00, 0x41, 0x7F, 0x40, 0x00, 0x00, 0x00, 0x00, // l
-0x7C, 0x04, 0x18, 0x04, 0x78, 0x00, 0x00, 0x00, // m
-0x7C, 0x08, 0x04, 0x04, 0x78, 0x00, 0x00, 0x00, // n
-0x38, 0x44, 0x44, 0x44, 0x38, 0x00, 0x00, 0x00, // o
-0xFC, 0x24, 0x24, 0x24, 0x18, 0x00, 0x00, 0x00, // p
-0x18, 0x24, 0x24, 0x24, 0xFC, 0x00, 0x00, 0x00, // q
-0x7C, 0x08, 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, // r
-0x48, 0x54, 0x54, 0x54, 0x24, 0x00, 0x00, 0x00, // s
-0x04, 0x3F, 0x44, 0x40, 0x20, 0x00, 0x00, 0x00, // t
-0x3C, 0x40, 0x40, 0x20, 0x7C, 0x00, 0x00, 0x00, // u
-0x1C, 0x20, 0x40, 0x20, 0x1C, 0x00, 0x00, 0x00, // v
-0x7C, 0x20, 0x18, 0x20, 0x7C, 0x00, 0x00, 0x00, // w
-0x44, 0x28, 0x10, 0x28, 0x44, 0x00, 0x00, 0x00, // x
-0x9C, 0xA0, 0xA0, 0xA0, 0x7C, 0x00, 0x00, 0x00, // y
-0x44, 0x64, 0x54, 0x4C, 0x44, 0x00, 0x00, 0x00  // z
-};
\ No newline at end of file
+#include <stdint.h>
+
+// Fontes geradas na compilação por tools/fontgen.py a partir dos arquivos BDF/PSF em fonts/. As tabelas
+// são `const` e ficam na flash.
+//
+// O bitmap de cada glifo está em ordem de página: para cada faixa de 8 linhas, as colunas da esquerda
+// para a direita, com o bit 0 na linha de cima, o mesmo formato de uma página do buffer do SSD1306.
+// Colunas vazias à direita não são guardadas; quem desenha completa com zeros até o avanço.
+
+typedef struct {
+  uint16_t offset;    // Primeiro byte do glifo em bitmap
+  uint8_t width;      // Colunas guardadas (0 em glifos vazios)
+  uint8_t advance;    // Distância até o próximo glifo
+} font_glyph_t;
+
+typedef struct {
+  const uint8_t *bitmap;
+  const font_glyph_t *glyphs;   // Um por código, de first a last
+  uint8_t first, last;          // Códigos fora do intervalo usam o glifo de `first` (o espaço)
+  uint8_t pages;                // Altura em páginas de 8 linhas
+} font_t;
+
+extern const font_t font_8x8;       // fonts/pomodoro-8x8.bdf: ASCII imprimível em células de 8x8
+extern const font_t font_digits;    // fonts/digits-16x32.bdf: dígitos de 16x32 e ':' para a contagem
+
+static inline const font_glyph_t *font_glyph(const font_t *font, char c) {
+  uint8_t code = (uint8_t) c;
+  if (code < font->first || code > font->last)
+    code = font->first;
+  return &font->glyphs[code - font->first];
+}
+
+#endif
@@ -0,0 +1,210 @@
+#include <stddef.h>
+#include <string.h>
+#include "history.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include "trace.h"
+
+#define HISTORY_OFFSET (PICO_FLASH_SIZE_BYTES - HISTORY_SECTORS * FLASH_SECTOR_SIZE)
+#define HISTORY_PAGES_PER_SECTOR (FLASH_SECTOR_SIZE / FLASH_PAGE_SIZE)
+#define HISTORY_PAGES (HISTORY_SECTORS * HISTORY_PAGES_PER_SECTOR)
+#define HISTORY_PER_PAGE (FLASH_PAGE_SIZE / sizeof(history_record_t))
+#define HISTORY_EMPTY 0xFFFFFFFFu
+
+_Static_assert(sizeof(history_record_t) == 16, "o registro deve dividir a página");
+_Static_assert(HISTORY_SECTORS >= 2, "o anel precisa de um setor além do que é apagado");
+
+static history_record_t history_page[HISTORY_PER_PAGE];   // Cópia da página aberta, posições livres em 0xFF
+static uint history_fill;           // Posições usadas na página aberta
+static uint history_written;        // Posições da página aberta que já estão na flash
+static uint32_t history_head;       // Página aberta do anel
+static uint32_t history_seq;        // Próximo número de sequência
+static uint16_t history_boot_count;
+static history_stats_t history_stats;
+
+static const history_record_t *history_flash_page(uint32_t page) {
+  return (const history_record_t *) (XIP_BASE + HISTORY_OFFSET + page * FLASH_PAGE_SIZE);
+}
+
+static uint8_t history_crc(const history_record_t *r) {
+  const uint8_t *bytes = (const uint8_t *) r;
+  uint8_t crc = 0;
+  for (uint i = 0; i < offsetof(history_record_t, check); ++i) {
+    crc ^= bytes[i];
+    for (uint b = 0; b < 8; ++b)
+      crc = crc & 0x80 ? (uint8_t) (crc << 1) ^ 0x07 : (uint8_t) (crc << 1);
+  }
+  return crc;
+}
+
+// Posições apagadas e registros de uma gravação interrompida não passam na verificação
+static bool history_valid(const history_record_t *r) {
+  return r->seq != HISTORY_EMPTY && r->check == history_crc(r);
+}
+
+static bool history_slot_blank(const history_record_t *r) {
+  const uint32_t *words = (const uint32_t *) r;
+  for (uint i = 0; i < sizeof(*r) / 4; ++i)
+    if (words[i] != 0xFFFFFFFFu)
+      return false;
+  return true;
+}
+
+static bool history_page_blank(uint32_t page) {
+  const uint32_t *words = (const uint32_t *) history_flash_page(page);
+  for (uint i = 0; i < FLASH_PAGE_SIZE / 4; ++i)
+    if (words[i] != 0xFFFFFFFFu)
+      return false;
+  return true;
+}
+
+static uint history_count_sector(uint32_t sector) {
+  uint count = 0;
+  for (uint32_t page = sector * HISTORY_PAGES_PER_SECTOR; page < (sector + 1) * HISTORY_PAGES_PER_SECTOR; ++page)
+    for (uint i = 0; i < HISTORY_PER_PAGE; ++i)
+      count += history_valid(&history_flash_page(page)[i]);
+  return count;
+}
+
+// Procura o registro mais recente. Se a página dele ainda tem posições apagadas no fim, ela continua aberta;
+// senão a gravação segue na página seguinte, pulando páginas já usadas por uma gravação interrompida até o
+// início do próximo setor, que será apagado.
+void history_init(void) {
+  uint32_t last_page = 0;
+  const history_record_t *last = NULL;
+
+  for (uint32_t page = 0; page < HISTORY_PAGES; ++page) {
+    const history_record_t *records = history_flash_page(page);
+    for (uint i = 0; i < HISTORY_PER_PAGE; ++i) {
+      if (!history_valid(&records[i]))
+        continue;
+      history_stats.stored++;
+      if (!last || records[i].seq > last->seq) {
+        last = &records[i];
+        last_page = page;
+      }
+    }
+  }
+
+  memset(history_page, 0xFF, sizeof(history_page));
+  if (last) {
+    history_seq = last->seq + 1;
+    history_boot_count = last->boot + 1;
+
+    // Posições não apagadas depois do último registro são de uma gravação interrompida e ficam para trás
+    const history_record_t *records = history_flash_page(last_page);
+    uint used = HISTORY_PER_PAGE;
+    while (used > 0 && history_slot_blank(&records[used - 1]))
+      --used;
+    if (used < HISTORY_PER_PAGE) {
+      history_head = last_page;
+      memcpy(history_page, records, sizeof(history_page));
+      history_fill = history_written = used;
+      return;
+    }
+    history_head = (last_page + 1) % HISTORY_PAGES;
+  }
+  while (history_head % HISTORY_PAGES_PER_SECTOR && !history_page_blank(history_head))
+    history_head = (history_head + 1) % HISTORY_PAGES;
+}
+
+uint16_t history_boot(void) {
+  return history_boot_count;
+}
+
+typedef struct {
+  uint32_t offset;
+  bool erase;
+} history_op_t;
+
+// Roda com as interrupções desligadas e o outro núcleo parado: a flash sai do modo XIP.
+static void history_flash_op(void *param) {
+  const history_op_t *op = param;
+  if (op->erase)
+    flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+  flash_range_program(op->offset, (const uint8_t *) history_page, FLASH_PAGE_SIZE);
+}
+
+// Grava a página aberta inteira: as posições já gravadas recebem os mesmos bytes e as livres continuam em
+// 0xFF, então só os registros novos mudam na flash. O setor é apagado só na primeira gravação da página que o
+// abre. Retorna false se a flash não pôde ser gravada; os registros continuam na cópia para a próxima tentativa.
+static bool history_commit(void) {
+  history_op_t op = {
+    .offset = HISTORY_OFFSET + history_head * FLASH_PAGE_SIZE,
+    .erase = !history_written && !(history_head % HISTORY_PAGES_PER_SECTOR),
+  };
+
+  // Ao entrar num setor, os registros que ele guardava (os mais antigos) deixam de existir
+  uint erased = op.erase ? history_count_sector(history_head / HISTORY_PAGES_PER_SECTOR) : 0;
+
+  TRACE_BEGIN_ARG(TRACE_FLASH, op.erase);
+  uint64_t start_us = time_us_64();
+  int result = flash_safe_execute(history_flash_op, &op, UINT32_MAX);
+  TRACE_END(TRACE_FLASH);
+  if (result != PICO_OK)
+    return false;
+  uint32_t elapsed = (uint32_t) (time_us_64() - start_us);
+
+  history_stats.pages++;
+  history_stats.erases += op.erase;
+  history_stats.stored += history_fill - history_written - erased;
+  if (elapsed > history_stats.commit_max_us)
+    history_stats.commit_max_us = elapsed;
+
+  history_written = history_fill;
+  if (history_fill == HISTORY_PER_PAGE) {
+    history_head = (history_head + 1) % HISTORY_PAGES;
+    history_fill = history_written = 0;
+    memset(history_page, 0xFF, sizeof(history_page));
+  }
+  return true;
+}
+
+// Só copia o registro para a próxima posição livre da página aberta; a gravação fica para o history_service.
+// Se a página encheu e a última gravação falhou, tenta de novo agora; falhando outra vez, o registro novo é
+// descartado e a página cheia espera a próxima tentativa.
+void history_append(const history_record_t *record) {
+  if (history_fill == HISTORY_PER_PAGE && !history_commit()) {
+    history_stats.dropped++;
+    return;
+  }
+
+  history_record_t *r = &history_page[history_fill++];
+  *r = *record;
+  r->seq = history_seq++;
+  r->check = history_crc(r);
+}
+
+// Chamada no laço principal: grava os registros novos, o que para o processador por até um apagamento de setor.
+void history_service(void) {
+  if (history_pending())
+    history_commit();
+}
+
+bool history_pending(void) {
+  return history_fill > history_written;
+}
+
+// Copia até `max` registros, do mais recente para o mais antigo, incluindo os que ainda não foram gravados.
+// A página aberta é lida da cópia em RAM, que pode trazer restos de uma gravação interrompida.
+uint history_latest(history_record_t *out, uint max) {
+  uint n = 0;
+  for (uint i = history_fill; i > 0 && n < max; --i)
+    if (history_valid(&history_page[i - 1]))
+      out[n++] = history_page[i - 1];
+
+  uint32_t page = history_head;
+  for (uint visited = 0; visited < HISTORY_PAGES && n < max; ++visited) {
+    page = (page + HISTORY_PAGES - 1) % HISTORY_PAGES;
+    const history_record_t *records = history_flash_page(page);
+    for (uint i = HISTORY_PER_PAGE; i > 0 && n < max; --i)
+      if (history_valid(&records[i - 1]))
+        out[n++] = records[i - 1];
+  }
+  return n;
+}
+
+void history_get_stats(history_stats_t *out) {
+  *out = history_stats;
+  out->pending = history_fill - history_written;
+}
@@ -0,0 +1,46 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "pico/stdlib.h"
+
+// Histórico das sessões concluídas, num anel de setores reservado no fim da flash.
+//
+// Os registros têm tamanho fixo e cada um é gravado na sua posição de 16 bytes da página aberta logo que chega,
+// no laço principal (fora das interrupções): a NOR programa as posições ainda apagadas sem apagar o setor, então
+// a página recebe uma gravação por registro e um corte de energia não perde sessões já concluídas. O anel só
+// passa à página seguinte quando a aberta enche, e só apaga um setor ao entrar nele, o mais antigo: cada setor é
+// apagado uma vez por volta, então o desgaste se distribui igualmente. Na inicialização o maior número de
+// sequência válido indica onde o anel parou, e uma página incompleta continua a receber registros.
+
+#define HISTORY_SECTORS 8           // 32 KiB, 2048 registros
+
+typedef struct {
+  uint32_t seq;             // Número de sequência; 0xFFFFFFFF numa posição apagada
+  uint32_t start_s;         // Início da sessão, em segundos desde o boot
+  uint16_t boot;            // Boot em que a sessão rodou, contado pelo próprio histórico
+  uint8_t preset_cycles;    // Índices das predefinições escolhidas no menu
+  uint8_t preset_work;
+  uint8_t preset_break;
+  uint8_t cycles_done;
+  uint8_t interruptions;    // Pausas durante a sessão
+  uint8_t check;            // CRC-8 dos bytes anteriores
+} history_record_t;
+
+typedef struct {
+  uint32_t stored;          // Registros válidos na flash
+  uint32_t pending;         // Registros ainda não gravados (a gravação falhou ou espera o history_service)
+  uint32_t pages;           // Gravações de página desde o boot, uma por registro
+  uint32_t erases;          // Setores apagados desde o boot
+  uint32_t commit_max_us;   // Maior tempo de uma gravação (página e, se preciso, apagamento)
+  uint32_t dropped;         // Registros descartados: a página aberta estava cheia e a gravação falhou
+} history_stats_t;
+
+void history_init(void);
+uint16_t history_boot(void);
+void history_append(const history_record_t *record);
+void history_service(void);
+bool history_pending(void);
+uint history_latest(history_record_t *out, uint max);
+void history_get_stats(history_stats_t *out);
+
+#endif
@@ -0,0 +1,132 @@
+#include "input.h"
+#include "hardware/adc.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "trace.h"
+
+#define INPUT_ADC_CLOCK_HZ 48000000u
+#define INPUT_FIFO_THRESHOLD 4 // Interrupção a cada 4 conversões (a FIFO tem 4 posições)
+
+static input_config_t input_cfg;
+
+// Fila do laço principal, alimentada pelas interrupções do ADC e do alarme de debounce
+static event_ring_t *input_events;
+
+// Filtro e estado do eixo X
+static uint32_t input_acc;
+static uint8_t input_acc_count;
+static int8_t input_dir;            // -1 esquerda, 0 centro, 1 direita
+static uint32_t input_next_repeat_us;
+static uint16_t input_repeat_count;
+
+// Estado do botão
+static bool input_button_down;
+static alarm_id_t input_debounce_alarm;
+
+// Classifica a leitura filtrada; a direção atual só é abandonada após cruzar a margem de histerese.
+static int8_t input_classify(uint16_t x) {
+  if (x > input_cfg.right_threshold || (input_dir > 0 && x > input_cfg.right_threshold - input_cfg.hysteresis))
+    return 1;
+  if (x < input_cfg.left_threshold || (input_dir < 0 && x < input_cfg.left_threshold + input_cfg.hysteresis))
+    return -1;
+  return 0;
+}
+
+// Uma leitura filtrada: gera o evento ao entrar em uma direção e as repetições enquanto ela é mantida.
+static void input_joystick_update(uint16_t x) {
+  int8_t dir = input_classify(x);
+  uint32_t now = time_us_32();
+
+  if (dir != input_dir) {
+    input_dir = dir;
+    if (dir) {
+      input_repeat_count = 0;
+      input_next_repeat_us = now + input_cfg.repeat_delay_ms * 1000u;
+      event_post(input_events, EVENT_JOYSTICK, dir, 0);
+    }
+  } else if (dir && input_cfg.repeat_delay_ms && (int32_t) (now - input_next_repeat_us) >= 0) {
+    if (input_repeat_count < UINT16_MAX)
+      input_repeat_count++;
+    input_next_repeat_us += input_cfg.repeat_interval_ms * 1000u;
+    event_post(input_events, EVENT_JOYSTICK, dir, input_repeat_count);
+  }
+}
+
+// A FIFO chega ao limiar: soma as conversões e, a cada `oversample` delas, processa a média.
+static void input_adc_irq_handler(void) {
+  TRACE_BEGIN(TRACE_IRQ_ADC);
+  while (!adc_fifo_is_empty()) {
+    input_acc += adc_fifo_get() & 0xFFF;
+    if (++input_acc_count == input_cfg.oversample) {
+      input_joystick_update(input_acc / input_cfg.oversample);
+      input_acc = 0;
+      input_acc_count = 0;
+    }
+  }
+  TRACE_END(TRACE_IRQ_ADC);
+}
+
+// O botão só muda de estado depois de ficar `debounce_ms` sem novas bordas.
+static int64_t input_debounce_callback(alarm_id_t id, void *user_data) {
+  (void) id;
+  (void) user_data;
+  input_debounce_alarm = 0;
+
+  bool down = !gpio_get(input_cfg.button_gpio);
+  if (down != input_button_down) {
+    input_button_down = down;
+    TRACE_INSTANT(TRACE_BUTTON, down);
+    event_post(input_events, EVENT_BUTTON, down, 0);
+  }
+  return 0;
+}
+
+static void input_gpio_irq_handler(uint gpio, uint32_t events) {
+  (void) events;
+  if (gpio != input_cfg.button_gpio)
+    return;
+
+  TRACE_BEGIN(TRACE_IRQ_GPIO);
+  if (input_debounce_alarm > 0)
+    cancel_alarm(input_debounce_alarm);
+  input_debounce_alarm = add_alarm_in_ms(input_cfg.debounce_ms, input_debounce_callback, NULL, true);
+  TRACE_END(TRACE_IRQ_GPIO);
+}
+
+void input_init(const input_config_t *config, event_ring_t *events) {
+  input_cfg = *config;
+  input_events = events;
+  if (!input_cfg.oversample)
+    input_cfg.oversample = 1;
+
+  gpio_init(input_cfg.button_gpio);
+  gpio_set_dir(input_cfg.button_gpio, GPIO_IN);
+  gpio_pull_up(input_cfg.button_gpio);
+  input_button_down = !gpio_get(input_cfg.button_gpio);
+  gpio_set_irq_enabled_with_callback(input_cfg.button_gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true,
+                                     input_gpio_irq_handler);
+
+  adc_init();
+  adc_gpio_init(26 + input_cfg.adc_input); // ADC0 a ADC3 ficam nos GPIO 26 a 29
+  adc_select_input(input_cfg.adc_input);
+  adc_fifo_setup(true, false, INPUT_FIFO_THRESHOLD, false, false);
+  adc_set_clkdiv((float) INPUT_ADC_CLOCK_HZ / input_cfg.sample_rate_hz - 1);
+  irq_set_exclusive_handler(ADC_IRQ_FIFO, input_adc_irq_handler);
+  adc_irq_set_enabled(true);
+  irq_set_enabled(ADC_IRQ_FIFO, true);
+}
+
+// Liga ou desliga a conversão contínua. Com o painel apagado o joystick não é usado, e desligar o ADC
+// evita acordar o processador a cada limiar da FIFO.
+void input_set_joystick(bool enabled) {
+  adc_run(enabled);
+  if (enabled)
+    return;
+
+  uint32_t irq = save_and_disable_interrupts();
+  adc_fifo_drain();
+  input_acc = 0;
+  input_acc_count = 0;
+  input_dir = 0;
+  restore_interrupts(irq);
+}
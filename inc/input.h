@@ -0,0 +1,26 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "pico/stdlib.h"
+#include "event.h"
+
+// Entradas da placa: eixo X do joystick amostrado continuamente pela FIFO do ADC e botão com debounce.
+// As interrupções transformam as leituras em eventos EVENT_JOYSTICK e EVENT_BUTTON na fila do laço principal.
+
+typedef struct {
+  uint adc_input;               // Canal do ADC do eixo X
+  uint button_gpio;             // Botão ativo em nível baixo
+  uint16_t sample_rate_hz;      // Conversões por segundo
+  uint8_t oversample;           // Conversões somadas em cada leitura filtrada
+  uint16_t left_threshold;      // Abaixo disso o eixo está à esquerda
+  uint16_t right_threshold;     // Acima disso o eixo está à direita
+  uint16_t hysteresis;          // Margem para sair de uma direção, contra oscilação no limiar
+  uint16_t repeat_delay_ms;     // Tempo segurando até a primeira repetição (0 desliga a repetição)
+  uint16_t repeat_interval_ms;  // Intervalo entre repetições
+  uint16_t debounce_ms;         // Tempo que o botão precisa ficar estável
+} input_config_t;
+
+void input_init(const input_config_t *config, event_ring_t *events);
+void input_set_joystick(bool enabled);
+
+#endif
@@ -0,0 +1,59 @@
+#include <string.h>
+#include "link.h"
+
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#endif
+
+static link_stats_t link_stats;
+
+// CRC-8 do quadro, continuando de `crc`. Quatro bits por vez, por uma tabela de 16 bytes: cerca de um
+// quarto das operações da versão bit a bit, o que pesa num Cortex-M0+ sem cache.
+static const uint8_t link_crc_nibble[16] = {
+  0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+};
+
+uint8_t link_crc(uint8_t crc, const uint8_t *bytes, uint len) {
+  for (uint i = 0; i < len; ++i) {
+    crc ^= bytes[i];
+    crc = (uint8_t) (crc << 4) ^ link_crc_nibble[crc >> 4];
+    crc = (uint8_t) (crc << 4) ^ link_crc_nibble[crc >> 4];
+  }
+  return crc;
+}
+
+// Sem a USB no stdio (POMODORO_STATS desligado) não há terminal, e os quadros são descartados.
+bool link_connected(void) {
+#if LIB_PICO_STDIO_USB
+  return stdio_usb_connected();
+#else
+  return false;
+#endif
+}
+
+// Monta o quadro e entrega ao driver da USB numa escrita só, sem a tradução de \n do stdio.
+// Retorna false, sem enviar, se não houver terminal conectado.
+bool link_send(uint8_t type, const void *payload, uint8_t len) {
+  if (!link_connected()) {
+    link_stats.dropped++;
+    return false;
+  }
+
+  uint8_t frame[LINK_OVERHEAD + UINT8_MAX];
+  frame[0] = LINK_SYNC;
+  frame[1] = type;
+  frame[2] = len;
+  memcpy(&frame[3], payload, len);
+  frame[3 + len] = link_crc(0, &frame[1], 2 + len);
+
+#if LIB_PICO_STDIO_USB
+  stdio_usb.out_chars((const char *) frame, LINK_OVERHEAD + len);
+#endif
+  link_stats.frames++;
+  link_stats.bytes += LINK_OVERHEAD + len;
+  return true;
+}
+
+void link_get_stats(link_stats_t *out) {
+  *out = link_stats;
+}
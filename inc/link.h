@@ -0,0 +1,36 @@
+#ifndef LINK_H
+#define LINK_H
+
+#include "pico/stdlib.h"
+
+// Quadros binários pela USB CDC, lado a lado com o texto do stdio (relatório do perfil).
+//
+//   0xA5 | tipo | comprimento | carga (comprimento bytes) | CRC-8
+//
+// A carga é a própria estrutura em RAM, little-endian como no RP2040, sem passar por printf. O CRC-8
+// (polinômio 0x07) cobre o tipo, o comprimento e a carga; o receptor procura o 0xA5, confere o CRC e, se
+// não bater, recomeça no byte seguinte, então o texto no meio do fluxo é ignorado. Um quadro vai numa
+// única escrita no driver da USB: até 64 bytes, um único pacote full-speed.
+
+#define LINK_SYNC 0xA5
+#define LINK_OVERHEAD 4             // Sincronismo, tipo, comprimento e CRC
+#define LINK_PACKET 64              // Pacote bulk da USB full-speed
+
+typedef enum {
+  LINK_STATS = 1,                   // stats_t (inc/stats.h)
+  LINK_TRACE = 2,                   // trace_chunk_t (inc/trace.h)
+  LINK_TRACE_NAME = 3,              // Identificador, faixa e nome de um evento do trace
+} link_type_t;
+
+typedef struct {
+  uint32_t frames;                  // Quadros enviados
+  uint32_t bytes;
+  uint32_t dropped;                 // Quadros descartados sem terminal conectado
+} link_stats_t;
+
+uint8_t link_crc(uint8_t crc, const uint8_t *bytes, uint len);
+bool link_connected(void);
+bool link_send(uint8_t type, const void *payload, uint8_t len);
+void link_get_stats(link_stats_t *out);
+
+#endif
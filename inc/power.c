@@ -0,0 +1,166 @@
+#include "power.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+
+// Modelo de consumo com valores típicos das folhas de dados (RP2040, SSD1306), em µA. Serve para
+// comparar modos entre si; não substitui a medição na placa.
+#define POWER_BASE_UA 1500             // Reguladores, XOSC, PLLs e flash em espera
+#define POWER_RUN_UA_PER_MHZ 140       // Núcleo executando
+#define POWER_SLEEP_UA_PER_MHZ 45      // Núcleo em __wfi, com a árvore de relógios ligada
+#define POWER_ADC_UA 400               // ADC convertendo sem parar (joystick, ligado com o painel aceso)
+#define POWER_PANEL_BASE_UA 450        // Painel ligado: lógica e bomba de carga
+#define POWER_PANEL_UA_PER_STEP 30     // Por passo de contraste, com o conteúdo típico das telas
+#define POWER_PANEL_OFF_UA 10
+
+static power_config_t power_cfg;
+static power_level_t power_current;
+static uint32_t power_idle_s;         // Segundos desde a última entrada
+
+static uint32_t power_full_hz;
+static bool power_clock_low;
+static uint64_t power_clock_since_us; // Início da frequência atual
+static uint64_t power_level_since_us; // Início do nível atual
+static uint64_t power_start_us;
+static power_stats_t power_stats;
+
+// Estado já aplicado ao painel pelo dono do display
+static power_level_t power_panel_applied = POWER_ACTIVE;
+
+static void power_account_clock(uint64_t now) {
+  power_stats.clock_us[power_clock_low] += now - power_clock_since_us;
+  power_clock_since_us = now;
+}
+
+static void power_account_level(uint64_t now) {
+  power_stats.level_us[power_current] += now - power_level_since_us;
+  power_level_since_us = now;
+}
+
+static void power_set_level(power_level_t level) {
+  power_account_level(time_us_64());
+  power_current = level;
+}
+
+static void power_set_clock(bool low) {
+  if (low == power_clock_low)
+    return;
+  power_account_clock(time_us_64());
+  clock_configure(clk_sys, CLOCKS_CLK_SYS_CTRL_SRC_VALUE_CLKSRC_CLK_SYS_AUX,
+                  CLOCKS_CLK_SYS_CTRL_AUXSRC_VALUE_CLKSRC_PLL_SYS, power_full_hz,
+                  low ? power_cfg.idle_khz * 1000 : power_full_hz);
+  power_clock_low = low;
+  power_stats.clock_switches++;
+}
+
+// Deve ser chamada com o clk_sys na frequência normal: é nela que o I2C e o PWM calculam os divisores.
+void power_init(const power_config_t *config) {
+  power_cfg = *config;
+  power_full_hz = clock_get_hz(clk_sys);
+  if (power_cfg.idle_khz * 1000 >= power_full_hz)
+    power_cfg.idle_khz = 0;
+
+  power_current = POWER_ACTIVE;
+  power_idle_s = 0;
+  power_reset_stats();
+}
+
+// Entrada do usuário: volta ao contraste normal. Retorna true se o painel estava apagado, e então
+// a entrada serve só para acendê-lo.
+bool power_activity(void) {
+  power_idle_s = 0;
+  if (power_current == POWER_ACTIVE)
+    return false;
+
+  bool was_blank = power_current == POWER_BLANK;
+  power_set_level(POWER_ACTIVE);
+  return was_blank;
+}
+
+// Chamada a cada segundo. Retorna true se o nível do painel mudou.
+bool power_tick(void) {
+  if (power_idle_s < UINT32_MAX)
+    power_idle_s++;
+
+  power_level_t level = POWER_ACTIVE;
+  if (power_cfg.blank_after_s && power_idle_s >= power_cfg.blank_after_s)
+    level = POWER_BLANK;
+  else if (power_cfg.dim_after_s && power_idle_s >= power_cfg.dim_after_s)
+    level = POWER_DIM;
+
+  if (level == power_current)
+    return false;
+  power_set_level(level);
+  return true;
+}
+
+power_level_t power_level(void) {
+  return power_current;
+}
+
+// Chamada por quem é dono do display, antes de desenhar. Contraste e liga/desliga vão numa única
+// transação, só quando o nível muda.
+void power_panel(ssd1306_t *ssd, power_level_t level) {
+  if (level == power_panel_applied)
+    return;
+
+  ssd1306_cmdlist_t list;
+  ssd1306_cmdlist_init(&list);
+  if (level != POWER_BLANK) {
+    ssd1306_cmdlist_add(&list, SET_CONTRAST);
+    ssd1306_cmdlist_add(&list, level == POWER_DIM ? power_cfg.dim_contrast : power_cfg.contrast);
+  }
+  ssd1306_cmdlist_add(&list, SET_DISP | (level != POWER_BLANK));
+  ssd1306_cmdlist_send(ssd, &list);
+  power_panel_applied = level;
+}
+
+// Volta ao relógio normal antes de desenhar ou de tocar um som (o PWM usa o clk_sys).
+void power_clock_full(void) {
+  power_set_clock(false);
+}
+
+// Dorme até a próxima interrupção. Chamada com as interrupções mascaradas; com `idle`, não há quadro
+// por desenhar, transferência no barramento, animação nem som, e o relógio pode ser reduzido. O relógio continua reduzido depois de acordar: só
+// volta ao normal quando há o que desenhar.
+void power_sleep(bool idle) {
+  if (idle && power_cfg.idle_khz)
+    power_set_clock(true);
+
+  uint64_t start_us = time_us_64();
+  __wfi();
+  power_stats.sleep_us[power_clock_low] += time_us_64() - start_us;
+  power_stats.wakeups++;
+}
+
+void power_get_stats(power_stats_t *out) {
+  uint64_t now = time_us_64();
+  power_account_clock(now);
+  power_account_level(now);
+
+  *out = power_stats;
+  out->elapsed_us = now - power_start_us;
+  if (!out->elapsed_us)
+    return;
+
+  // Média ponderada pelo tempo de cada estado. Sem painel aceso, o ADC do joystick fica desligado.
+  double mhz[2] = { power_full_hz / 1e6, power_cfg.idle_khz / 1e3 };
+  double charge = (double) POWER_BASE_UA * out->elapsed_us;
+  for (uint i = 0; i < 2; ++i) {
+    charge += POWER_RUN_UA_PER_MHZ * mhz[i] * (out->clock_us[i] - out->sleep_us[i]);
+    charge += POWER_SLEEP_UA_PER_MHZ * mhz[i] * out->sleep_us[i];
+  }
+  uint64_t lit_us = out->level_us[POWER_ACTIVE] + out->level_us[POWER_DIM];
+  charge += (double) POWER_ADC_UA * lit_us;
+  charge += (POWER_PANEL_BASE_UA + (double) POWER_PANEL_UA_PER_STEP * power_cfg.contrast) * out->level_us[POWER_ACTIVE];
+  charge += (POWER_PANEL_BASE_UA + (double) POWER_PANEL_UA_PER_STEP * power_cfg.dim_contrast) * out->level_us[POWER_DIM];
+  charge += (double) POWER_PANEL_OFF_UA * out->level_us[POWER_BLANK];
+  out->estimated_ua = (uint32_t) (charge / out->elapsed_us);
+}
+
+void power_reset_stats(void) {
+  uint64_t now = time_us_64();
+  power_stats = (power_stats_t) { 0 };
+  power_start_us = now;
+  power_clock_since_us = now;
+  power_level_since_us = now;
+}
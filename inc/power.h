@@ -0,0 +1,55 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+// Gerência de energia do laço principal.
+//
+// - Painel: depois de `dim_after_s` segundos sem entrada o contraste cai para `dim_contrast`; depois de
+//   `blank_after_s` o painel é desligado (SET_DISP). Apagado, nada é desenhado nem enviado, e a primeira
+//   entrada só acende a tela.
+// - Relógio: enquanto o laço dorme sem quadro, transferência I2C, animação nem som, clk_sys cai para
+//   `idle_khz`. O I2C e o PWM são medidos pelo clk_sys, então o relógio volta ao normal antes de qualquer
+//   envio ao display ou nota.
+// - Sono: __wfi entre as interrupções (ticks, ADC, botão, DMA). O modo dormant pararia o timer que move
+//   o tick, então não é usado.
+//
+// Os tempos em cada estado alimentam uma estimativa do consumo médio, para comparar configurações.
+
+typedef enum {
+  POWER_ACTIVE,   // Contraste normal
+  POWER_DIM,      // Contraste reduzido
+  POWER_BLANK,    // Painel desligado
+  POWER_LEVELS
+} power_level_t;
+
+typedef struct {
+  uint16_t dim_after_s;     // Segundos sem entrada até reduzir o contraste (0 nunca reduz)
+  uint16_t blank_after_s;   // Segundos sem entrada até desligar o painel (0 nunca desliga)
+  uint8_t contrast;         // Contraste normal
+  uint8_t dim_contrast;     // Contraste reduzido
+  uint32_t idle_khz;        // clk_sys durante a espera (0 mantém o relógio)
+} power_config_t;
+
+typedef struct {
+  uint32_t wakeups;               // Saídas do __wfi
+  uint32_t clock_switches;        // Trocas de frequência do clk_sys
+  uint64_t elapsed_us;            // Tempo medido desde o início ou o último reset
+  uint64_t sleep_us[2];           // Dormindo: [0] relógio normal, [1] reduzido
+  uint64_t clock_us[2];           // Tempo total em cada frequência
+  uint64_t level_us[POWER_LEVELS];
+  uint32_t estimated_ua;          // Corrente média estimada no período
+} power_stats_t;
+
+void power_init(const power_config_t *config);
+bool power_activity(void);
+bool power_tick(void);
+power_level_t power_level(void);
+void power_panel(ssd1306_t *ssd, power_level_t level);
+void power_clock_full(void);
+void power_sleep(bool idle);
+void power_get_stats(power_stats_t *out);
+void power_reset_stats(void);
+
+#endif
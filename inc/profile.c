@@ -0,0 +1,193 @@
+#include "profile.h"
+
+#if POMODORO_PROFILE
+
+#include <stdio.h>
+#include "tick.h"
+#include "history.h"
+#include "power.h"
+#include "link.h"
+
+static const char *const profile_names[PROFILE_COUNT] = {
+  [PROFILE_RENDER] = "render",
+  [PROFILE_FLUSH] = "flush",
+  [PROFILE_FLUSH_WAIT] = "flush_wait",
+  [PROFILE_SOUND] = "sound",
+  [PROFILE_EVENTS] = "events",
+  [PROFILE_FIRST_FRAME] = "boot",
+};
+
+// Cada trecho é gravado por um único contexto (núcleo ou interrupção), então não há disputa
+// entre escritores. O relatório lê sem travar: uma medição em andamento pode aparecer pela metade.
+static profile_hist_t profile_hist[PROFILE_COUNT];
+static volatile bool profile_dump_due;
+static struct repeating_timer profile_timer;
+static const event_ring_t *profile_events;
+static profile_duty_t *profile_duty;
+
+static uint profile_bucket(uint32_t us) {
+  if (us < 8)
+    return us;
+
+  uint msb = 31 - __builtin_clz(us);
+  uint index = 8 + (msb - 3) * 4 + ((us >> (msb - 2)) & 3);
+  return index < PROFILE_BUCKETS ? index : PROFILE_BUCKETS - 1;
+}
+
+// Maior duração que cai no bucket
+static uint32_t profile_bucket_limit(uint index) {
+  if (index < 8)
+    return index;
+
+  uint msb = (index - 8) / 4 + 3;
+  uint sub = (index - 8) % 4;
+  return ((4u + sub + 1) << (msb - 2)) - 1;
+}
+
+static bool profile_timer_callback(struct repeating_timer *t) {
+  (void) t;
+  profile_dump_due = true;
+  return true;
+}
+
+void profile_init(void) {
+  profile_reset();
+  if (PROFILE_PERIOD_MS)
+    add_repeating_timer_ms(PROFILE_PERIOD_MS, profile_timer_callback, NULL, &profile_timer);
+}
+
+// Inclui no relatório a vazão da fila de eventos
+void profile_watch_events(const event_ring_t *ring) {
+  profile_events = ring;
+}
+
+// Inclui no relatório o ciclo de trabalho dos núcleos; 'r' também zera esses contadores
+void profile_watch_duty(profile_duty_t *duty) {
+  profile_duty = duty;
+}
+
+void profile_record(profile_scope_t scope, uint32_t us) {
+  profile_hist_t *h = &profile_hist[scope];
+  if (!h->count || us < h->min_us) h->min_us = us;
+  if (us > h->max_us) h->max_us = us;
+  h->count++;
+  h->sum_us += us;
+  h->buckets[profile_bucket(us)]++;
+}
+
+void profile_reset(void) {
+  for (uint i = 0; i < PROFILE_COUNT; ++i)
+    profile_hist[i] = (profile_hist_t) { 0 };
+  if (profile_duty)
+    *profile_duty = (profile_duty_t) { .start_us = time_us_64() };
+}
+
+// Percentil estimado pelo limite superior do bucket, nunca acima do máximo observado.
+static uint32_t profile_percentile(const profile_hist_t *h, uint32_t permille) {
+  uint32_t target = (uint32_t) (((uint64_t) h->count * permille + 999) / 1000);
+  uint32_t seen = 0;
+  for (uint i = 0; i < PROFILE_BUCKETS; ++i) {
+    seen += h->buckets[i];
+    if (seen >= target) {
+      uint32_t limit = profile_bucket_limit(i);
+      return limit < h->max_us ? limit : h->max_us;
+    }
+  }
+  return h->max_us;
+}
+
+void profile_dump(void) {
+  printf("[prof] t=%lu ms\n", (unsigned long) to_ms_since_boot(get_absolute_time()));
+  for (uint i = 0; i < PROFILE_COUNT; ++i) {
+    const profile_hist_t *h = &profile_hist[i];
+    if (!h->count)
+      continue;
+    printf("[prof] %-10s n=%lu min=%lu avg=%lu p99=%lu max=%lu us\n",
+           profile_names[i], (unsigned long) h->count, (unsigned long) h->min_us,
+           (unsigned long) (h->sum_us / h->count), (unsigned long) profile_percentile(h, 990),
+           (unsigned long) h->max_us);
+  }
+
+  // Quadros desenhados e fração do tempo acordado de cada núcleo (o núcleo 1 só no modo de dois núcleos)
+  uint64_t duty_us = profile_duty ? time_us_64() - profile_duty->start_us : 0;
+  if (duty_us) {
+    printf("[prof] duty       renders=%lu", (unsigned long) profile_duty->renders);
+    for (uint core = 0; core < count_of(profile_duty->busy_us); ++core) {
+      uint32_t permille = (uint32_t) (profile_duty->busy_us[core] * 1000 / duty_us);
+      if (core == 0 || profile_duty->busy_us[core])
+        printf(" core%u=%lu.%lu%%", core, (unsigned long) (permille / 10), (unsigned long) (permille % 10));
+    }
+    printf("\n");
+  }
+
+  if (profile_events && profile_events->batches) {
+    const event_ring_t *ring = profile_events;
+    printf("[prof] queue      posted=%lu dropped=%lu peak=%lu/%lu batches=%lu per_batch=%lu.%02lu\n",
+           (unsigned long) ring->posted, (unsigned long) ring->dropped, (unsigned long) ring->peak,
+           (unsigned long) (ring->mask + 1), (unsigned long) ring->batches,
+           (unsigned long) (ring->tail / ring->batches), (unsigned long) (ring->tail % ring->batches * 100 / ring->batches));
+  }
+
+  // Atraso de entrega dos ticks em relação aos prazos absolutos
+  tick_stats_t tick;
+  tick_get_stats(&tick);
+  if (tick.ticks) {
+    printf("[prof] tick       n=%lu late_avg=%lu late_max=%lu us catch_up=%lu pauses=%lu paused=%lu ms\n",
+           (unsigned long) tick.ticks, (unsigned long) (tick.late_sum_us / tick.ticks),
+           (unsigned long) tick.late_max_us, (unsigned long) tick.catch_up, (unsigned long) tick.pauses,
+           (unsigned long) (tick.paused_us / 1000));
+  }
+
+  history_stats_t history;
+  history_get_stats(&history);
+  if (history.stored || history.pending || history.dropped) {
+    printf("[prof] history    stored=%lu pending=%lu pages=%lu erases=%lu commit_max=%lu us dropped=%lu\n",
+           (unsigned long) history.stored, (unsigned long) history.pending, (unsigned long) history.pages,
+           (unsigned long) history.erases, (unsigned long) history.commit_max_us, (unsigned long) history.dropped);
+  }
+
+  link_stats_t link;
+  link_get_stats(&link);
+  if (link.frames || link.dropped) {
+    printf("[prof] link       frames=%lu bytes=%lu dropped=%lu\n",
+           (unsigned long) link.frames, (unsigned long) link.bytes, (unsigned long) link.dropped);
+  }
+
+  // Despertares, fração do tempo dormindo, no relógio reduzido e com o painel escuro/apagado, e o consumo estimado
+  power_stats_t power;
+  power_get_stats(&power);
+  if (power.elapsed_us) {
+    uint64_t sleep_us = power.sleep_us[0] + power.sleep_us[1];
+    printf("[prof] power      wakeups=%lu sleep=%lu%% clock_low=%lu%% dim=%lu%% blank=%lu%% switches=%lu est=%lu uA\n",
+           (unsigned long) power.wakeups, (unsigned long) (sleep_us * 100 / power.elapsed_us),
+           (unsigned long) (power.clock_us[1] * 100 / power.elapsed_us),
+           (unsigned long) (power.level_us[POWER_DIM] * 100 / power.elapsed_us),
+           (unsigned long) (power.level_us[POWER_BLANK] * 100 / power.elapsed_us),
+           (unsigned long) power.clock_switches, (unsigned long) power.estimated_ua);
+  }
+}
+
+// Comando recebido pelo stdio: 'p' pede o relatório, 'r' zera as medições.
+void profile_command(int c) {
+  if (c == 'p') {
+    profile_dump();
+  } else if (c == 'r') {
+    profile_reset();
+    tick_reset_stats();
+    power_reset_stats();
+  }
+}
+
+// Chamada no laço principal: o relatório periódico.
+void profile_poll(void) {
+  if (profile_dump_due) {
+    profile_dump_due = false;
+    profile_dump();
+  }
+}
+
+bool profile_pending(void) {
+  return profile_dump_due;
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "pico/stdlib.h"
+#include "event.h"
+
+// Perfil de tempo por trecho nomeado. Cada trecho acumula as durações (µs, pelo timer do sistema)
+// em um histograma de buckets fixos, sem alocação. Com POMODORO_PROFILE desligado as macros
+// e as funções somem do código.
+//
+//   PROFILE_BEGIN(PROFILE_RENDER);
+//   render_ui(&ssd, &ui);
+//   PROFILE_END(PROFILE_RENDER);
+//
+// O relatório (mín/média/p99/máx) sai pelo stdio a cada PROFILE_PERIOD_MS, ou ao receber 'p';
+// 'r' zera as medições.
+
+typedef enum {
+  PROFILE_RENDER,       // Desenho de uma tela no buffer
+  PROFILE_FLUSH,        // Montagem do quadro e início do DMA
+  PROFILE_FLUSH_WAIT,   // Espera por um buffer frontal livre
+  PROFILE_SOUND,        // Enfileiramento do efeito sonoro
+  PROFILE_EVENTS,       // Tratamento de um lote da fila de eventos
+  PROFILE_FIRST_FRAME,  // Do reset até o primeiro quadro completo no display (registrado uma vez)
+  PROFILE_COUNT
+} profile_scope_t;
+
+#ifndef PROFILE_PERIOD_MS
+#define PROFILE_PERIOD_MS 10000 // 0 desliga o relatório periódico
+#endif
+
+// Ciclo de trabalho dos núcleos. Os contadores existem mesmo sem o perfil: quem desenha e os laços
+// de cada núcleo os atualizam, e o relatório mostra a fração do tempo acordado.
+typedef struct {
+  uint32_t renders;           // Quadros desenhados
+  uint64_t busy_us[2];        // Tempo acordado (desenhando ou enviando), por núcleo
+  uint64_t start_us;          // Início da medição
+} profile_duty_t;
+
+#if POMODORO_PROFILE
+
+// Buckets 0 a 7 são exatos; a partir daí cada potência de 2 é dividida em 4.
+// O último bucket acumula tudo acima de ~16 s.
+#define PROFILE_BUCKETS 92
+
+typedef struct {
+  uint32_t count;
+  uint32_t min_us, max_us;
+  uint64_t sum_us;
+  uint32_t buckets[PROFILE_BUCKETS];
+} profile_hist_t;
+
+#define PROFILE_BEGIN(scope) uint32_t profile_start_##scope = time_us_32()
+#define PROFILE_END(scope) profile_record(scope, time_us_32() - profile_start_##scope)
+
+void profile_init(void);
+void profile_watch_events(const event_ring_t *ring);
+void profile_watch_duty(profile_duty_t *duty);
+void profile_record(profile_scope_t scope, uint32_t us);
+void profile_reset(void);
+void profile_dump(void);
+void profile_command(int c);
+void profile_poll(void);
+bool profile_pending(void);
+
+#else
+
+#define PROFILE_BEGIN(scope) do {} while (0)
+#define PROFILE_END(scope) do {} while (0)
+
+static inline void profile_init(void) {}
+static inline void profile_watch_events(const event_ring_t *ring) { (void) ring; }
+static inline void profile_watch_duty(profile_duty_t *duty) { (void) duty; }
+static inline void profile_record(profile_scope_t scope, uint32_t us) { (void) scope; (void) us; }
+static inline void profile_reset(void) {}
+static inline void profile_dump(void) {}
+static inline void profile_command(int c) { (void) c; }
+static inline void profile_poll(void) {}
+static inline bool profile_pending(void) { return false; }
+
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+#include <stddef.h>
+#include "session.h"
+
+// O tick da roda é de um segundo
+#define SESSION_TICKS_PER_MINUTE 60u
+
+static session_t sessions[SESSION_MAX];
+static uint session_count;
+static wheel_t session_wheel;
+static session_phase_end_t session_on_phase_end;
+
+static session_t *session_of(wheel_timer_t *timer) {
+  return (session_t *) ((uint8_t *) timer - offsetof(session_t, timer));
+}
+
+static uint32_t session_phase_ticks(const session_t *s) {
+  return (s->phase == PHASE_WORK ? s->work_minutes : s->break_minutes) * SESSION_TICKS_PER_MINUTE;
+}
+
+static void session_begin_phase(session_t *s, uint8_t phase) {
+  s->phase = phase;
+  wheel_add(&session_wheel, &s->timer, s->timer.expires + session_phase_ticks(s));
+}
+
+// Fim do trabalho: começa o intervalo. Fim do intervalo: contabiliza um ciclo e, se for o último,
+// libera a sessão. O próximo prazo parte do prazo anterior, não do tick em que foi tratado.
+static void session_expired(wheel_timer_t *timer) {
+  session_t *s = session_of(timer);
+  uint8_t phase = s->phase;
+
+  if (phase == PHASE_WORK) {
+    session_begin_phase(s, PHASE_BREAK);
+  } else if (--s->cycles_remaining) {
+    session_begin_phase(s, PHASE_WORK);
+  } else {
+    s->used = false;
+    session_count--;
+  }
+
+  if (session_on_phase_end)
+    session_on_phase_end(s, phase);
+}
+
+void sessions_init(uint32_t now, session_phase_end_t on_phase_end) {
+  wheel_init(&session_wheel, now);
+  session_on_phase_end = on_phase_end;
+  session_count = 0;
+  for (uint i = 0; i < SESSION_MAX; ++i)
+    sessions[i].used = false;
+}
+
+// Leva a roda até o tick `now`, tratando as fases que terminaram no caminho.
+void sessions_advance(uint32_t now) {
+  wheel_advance(&session_wheel, now);
+}
+
+// Começa uma sessão no tick atual. Retorna NULL se todas as vagas estiverem ocupadas.
+session_t *session_start(uint8_t cycles, uint8_t work_minutes, uint8_t break_minutes) {
+  for (uint i = 0; i < SESSION_MAX; ++i) {
+    session_t *s = &sessions[i];
+    if (s->used)
+      continue;
+
+    *s = (session_t) {
+      .used = true,
+      .phase = PHASE_WORK,
+      .cycles = cycles,
+      .cycles_remaining = cycles,
+      .started = session_wheel.now,
+      .work_minutes = work_minutes,
+      .break_minutes = break_minutes,
+      .timer = { .callback = session_expired },
+    };
+    wheel_add(&session_wheel, &s->timer, session_wheel.now + session_phase_ticks(s));
+    session_count++;
+    return s;
+  }
+  return NULL;
+}
+
+// Tira a sessão da roda guardando quanto faltava da fase, e a devolve com o mesmo saldo.
+// A resolução é de um tick.
+void session_toggle_pause(session_t *s) {
+  if (s->paused) {
+    s->paused = false;
+    wheel_add(&session_wheel, &s->timer, session_wheel.now + s->paused_left);
+  } else {
+    s->paused_left = s->timer.expires - session_wheel.now;
+    wheel_cancel(&session_wheel, &s->timer);
+    s->paused = true;
+    if (s->pauses < UINT8_MAX)
+      s->pauses++;
+  }
+}
+
+uint sessions_active(void) {
+  return session_count;
+}
+
+// Sessão ativa de posição `index`, na ordem das vagas; usada para paginar o display.
+session_t *session_at(uint index) {
+  for (uint i = 0; i < SESSION_MAX; ++i) {
+    if (sessions[i].used && !index--)
+      return &sessions[i];
+  }
+  return NULL;
+}
+
+// Posição da sessão entre as ativas, ou -1 se ela já terminou.
+int session_index(const session_t *session) {
+  if (!session->used)
+    return -1;
+  int index = 0;
+  for (const session_t *s = sessions; s < session; ++s)
+    index += s->used;
+  return index;
+}
+
+static uint32_t session_phase_left(const session_t *s) {
+  return s->paused ? s->paused_left : s->timer.expires - session_wheel.now;
+}
+
+// Segundos de trabalho cumpridos no ciclo atual: contam durante o trabalho e ficam cheios no intervalo.
+uint16_t session_work_seconds(const session_t *s) {
+  uint32_t total = s->work_minutes * SESSION_TICKS_PER_MINUTE;
+  return s->phase == PHASE_WORK ? total - session_phase_left(s) : total;
+}
+
+// Segundos restantes de intervalo: zero durante o trabalho, contagem regressiva no intervalo.
+uint16_t session_break_seconds(const session_t *s) {
+  return s->phase == PHASE_BREAK ? session_phase_left(s) : 0;
+}
+
+// Copia as sessões em andamento, na ordem das páginas.
+uint sessions_save(session_snapshot_t *out, uint max) {
+  uint n = 0;
+  for (uint i = 0; i < SESSION_MAX && n < max; ++i) {
+    const session_t *s = &sessions[i];
+    if (!s->used)
+      continue;
+    out[n++] = (session_snapshot_t) {
+      .preset = { s->preset[0], s->preset[1], s->preset[2] },
+      .cycles = s->cycles,
+      .cycles_remaining = s->cycles_remaining,
+      .work_minutes = s->work_minutes,
+      .break_minutes = s->break_minutes,
+      .phase = s->phase,
+      .paused = s->paused,
+      .pauses = s->pauses,
+      .phase_left = session_phase_left(s),
+    };
+  }
+  return n;
+}
+
+// Recria uma sessão salva a partir do tick atual, com o mesmo saldo da fase em andamento.
+session_t *session_restore(const session_snapshot_t *snapshot) {
+  if (!snapshot->cycles_remaining || snapshot->phase > PHASE_BREAK)
+    return NULL;
+
+  session_t *s = session_start(snapshot->cycles, snapshot->work_minutes, snapshot->break_minutes);
+  if (!s)
+    return NULL;
+
+  s->preset[0] = snapshot->preset[0];
+  s->preset[1] = snapshot->preset[1];
+  s->preset[2] = snapshot->preset[2];
+  s->cycles_remaining = snapshot->cycles_remaining;
+  s->phase = snapshot->phase;
+  s->pauses = snapshot->pauses;
+  if (snapshot->paused) {
+    wheel_cancel(&session_wheel, &s->timer);
+    s->paused = true;
+    s->paused_left = snapshot->phase_left;
+  } else {
+    wheel_add(&session_wheel, &s->timer, session_wheel.now + snapshot->phase_left);
+  }
+  return s;
+}
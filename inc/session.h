@@ -0,0 +1,62 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include "pico/stdlib.h"
+#include "wheel.h"
+
+// Sessões pomodoro independentes, todas na mesma roda de temporizadores movida por um único tick.
+//
+// Cada sessão ocupa um único temporizador na roda, com o prazo do fim da fase em andamento. Os segundos
+// exibidos são calculados a partir desse prazo, então um tick não visita as sessões: só as fases que
+// terminam naquele tick custam alguma coisa.
+
+#define SESSION_MAX 32
+
+enum { PHASE_WORK, PHASE_BREAK };
+
+typedef struct session {
+  wheel_timer_t timer;        // Fim da fase em andamento
+  bool used;
+  bool paused;
+  uint8_t phase;              // PHASE_WORK ou PHASE_BREAK
+  uint8_t cycles;             // Configuração da sessão
+  uint8_t cycles_remaining;
+  uint8_t work_minutes;
+  uint8_t break_minutes;
+  uint8_t pauses;             // Vezes em que a sessão foi pausada
+  uint8_t preset[3];          // Índices das predefinições escolhidas no menu, guardados para o histórico
+  uint32_t started;           // Tick em que a sessão começou
+  uint32_t paused_left;       // Ticks que faltavam para o fim da fase quando a sessão foi pausada
+} session_t;
+
+// Estado de uma sessão em andamento, compacto para o checkpoint na flash. O tempo já cumprido fica
+// implícito no que falta da fase; o instante de início não sobrevive a um reset.
+typedef struct {
+  uint8_t preset[3];
+  uint8_t cycles;
+  uint8_t cycles_remaining;
+  uint8_t work_minutes;
+  uint8_t break_minutes;
+  uint8_t phase;
+  uint8_t paused;
+  uint8_t pauses;
+  uint16_t phase_left;        // Segundos até o fim da fase
+} session_snapshot_t;
+
+// Chamado no fim de cada fase, depois da transição. `phase` é a fase que terminou; no fim do último
+// intervalo a sessão já foi liberada quando o callback roda.
+typedef void (*session_phase_end_t)(session_t *session, uint8_t phase);
+
+void sessions_init(uint32_t now, session_phase_end_t on_phase_end);
+void sessions_advance(uint32_t now);
+session_t *session_start(uint8_t cycles, uint8_t work_minutes, uint8_t break_minutes);
+void session_toggle_pause(session_t *session);
+uint sessions_active(void);
+session_t *session_at(uint index);
+int session_index(const session_t *session);
+uint16_t session_work_seconds(const session_t *session);
+uint16_t session_break_seconds(const session_t *session);
+uint sessions_save(session_snapshot_t *out, uint max);
+session_t *session_restore(const session_snapshot_t *snapshot);
+
+#endif
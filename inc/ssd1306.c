@@ -1,117 +1,567 @@
+#include <string.h>
 #include "ssd1306.h"
-#include "font.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "trace.h"
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+// Com SSD1306_STATIC, geometria, porta I2C e endereço são as constantes de ssd1306.h e os buffers são
+// estáticos: limites, passos entre colunas e índices das primitivas viram constantes na compilação e
+// não há alocação no heap. Só um display por firmware. Sem SSD1306_STATIC, tudo vem do ssd1306_t
+// preenchido por ssd1306_init, como numa biblioteca genérica.
+#if SSD1306_STATIC
+// O byte 0 do buffer é o controle 0x40; o deslocamento de 3 deixa os dados do quadro alinhados a 4 bytes
+static uint8_t ssd1306_ram[3 + SSD1306_BUFSIZE] __attribute__((aligned(4)));
+static uint8_t ssd1306_shadow[SSD1306_BUFSIZE - 1] __attribute__((aligned(4)));
+static uint16_t ssd1306_dma[2][SSD1306_DMA_WORDS] __attribute__((aligned(4)));
+
+#define SSD_WIDTH(ssd) WIDTH
+#define SSD_HEIGHT(ssd) HEIGHT
+#define SSD_PAGES(ssd) (HEIGHT / 8)
+#define SSD_BUFSIZE(ssd) SSD1306_BUFSIZE
+#define SSD_RAM(ssd) (&ssd1306_ram[3])
+#define SSD_SHADOW(ssd) ssd1306_shadow
+#define SSD_I2C(ssd) SSD1306_I2C
+#define SSD_ADDRESS(ssd) SSD1306_ADDRESS
+#define SSD_BACKEND(ssd) SSD1306_BACKEND
+#else
+#define SSD_WIDTH(ssd) ((ssd)->width)
+#define SSD_HEIGHT(ssd) ((ssd)->height)
+#define SSD_PAGES(ssd) ((ssd)->pages)
+#define SSD_BUFSIZE(ssd) ((ssd)->bufsize)
+#define SSD_RAM(ssd) ((ssd)->ram_buffer)
+#define SSD_SHADOW(ssd) ((ssd)->shadow)
+#define SSD_I2C(ssd) ((ssd)->i2c_port)
+#define SSD_ADDRESS(ssd) ((ssd)->address)
+#define SSD_BACKEND(ssd) ((ssd)->backend)
+#endif
+
+// Display associado a cada canal DMA, consultado pela interrupção de fim de transferência.
+static ssd1306_t *dma_owner[NUM_DMA_CHANNELS];
+static void ssd1306_dma_irq_handler(void);
+
+static inline void ssd1306_clear_dirty(ssd1306_t *ssd) {
+  ssd->dirty_x0 = 0xFF;
+  ssd->dirty_x1 = 0;
+  ssd->dirty_p0 = 0xFF;
+  ssd->dirty_p1 = 0;
+}
+
+// Acumula o retângulo (x0, y0)-(x1, y1) na região suja, recortado aos limites do display.
+static void ssd1306_mark_dirty_clip(ssd1306_t *ssd, int x0, int y0, int x1, int y1) {
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 >= SSD_WIDTH(ssd)) x1 = SSD_WIDTH(ssd) - 1;
+  if (y1 >= SSD_HEIGHT(ssd)) y1 = SSD_HEIGHT(ssd) - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
+
+  if (x0 < ssd->dirty_x0) ssd->dirty_x0 = x0;
+  if (x1 > ssd->dirty_x1) ssd->dirty_x1 = x1;
+  if ((y0 >> 3) < ssd->dirty_p0) ssd->dirty_p0 = y0 >> 3;
+  if ((y1 >> 3) > ssd->dirty_p1) ssd->dirty_p1 = y1 >> 3;
+}
+
+void ssd1306_init(ssd1306_t *ssd, const ssd1306_backend_t *backend, uint8_t width, uint8_t height, bool external_vcc,
+                  uint8_t address, i2c_inst_t *i2c) {
+  ssd->backend = backend;
+  ssd->external_vcc = external_vcc;
   ssd->width = width;
   ssd->height = height;
   ssd->pages = height / 8U;
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+#if SSD1306_STATIC
+  hard_assert(backend == SSD1306_BACKEND && width == WIDTH && height == HEIGHT && address == SSD1306_ADDRESS &&
+              i2c == SSD1306_I2C);
+  ssd->ram_buffer = SSD_RAM(ssd);
+  ssd->shadow = SSD_SHADOW(ssd);
+  ssd->dma_buffer[0] = ssd1306_dma[0];
+  ssd->dma_buffer[1] = ssd1306_dma[1];
+  ssd->heap_bytes = 0;
+#else
+  // Dois buffers frontais com o quadro já codificado para o registrador IC_DATA_CMD: no pior caso uma
+  // janela por página, cada uma com até 8 bytes de endereçamento e controle, e os dados.
+  size_t words = ssd->pages * 8 + ssd->bufsize;
+  ssd->ram_buffer = malloc(ssd->bufsize);
+  ssd->shadow = malloc(ssd->bufsize - 1);
+  ssd->dma_buffer[0] = malloc(words * sizeof(uint16_t));
+  ssd->dma_buffer[1] = malloc(words * sizeof(uint16_t));
+  ssd->heap_bytes = 2 * ssd->bufsize - 1 + 2 * words * sizeof(uint16_t);
+#endif
+  memset(ssd->ram_buffer, 0, ssd->bufsize);
+  memset(ssd->shadow, 0, ssd->bufsize - 1);
   ssd->ram_buffer[0] = 0x40;
-  ssd->port_buffer[0] = 0x80;
+  ssd->shadow_valid = false;
+  ssd->frame_bytes = 0;
+  ssd->total_bytes = 0;
+  ssd->frames = 0;
+
+  // O conteúdo inicial da RAM do display é indefinido, então o primeiro envio cobre a tela toda.
+  ssd1306_clear_dirty(ssd);
+  ssd1306_mark_dirty_clip(ssd, 0, 0, width - 1, height - 1);
+
+  ssd->dma_front = 0;
+  ssd->dma_busy = false;
+  ssd->dma_pending = false;
+
+  ssd->dma_channel = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(ssd->dma_channel);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, i2c_get_dreq(i2c, true));
+  dma_channel_configure(ssd->dma_channel, &c, &i2c_get_hw(i2c)->data_cmd, NULL, 0, false);
+
+  dma_owner[ssd->dma_channel] = ssd;
+  dma_channel_set_irq0_enabled(ssd->dma_channel, true);
+
+  // Um handler atende todos os displays
+  static bool irq_installed;
+  if (!irq_installed) {
+    irq_add_shared_handler(DMA_IRQ_0, ssd1306_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    irq_installed = true;
+  }
 }
 
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1) {
+  ssd1306_mark_dirty_clip(ssd, x0, y0, x1, y1);
+}
+
+// A sequência de inicialização do controlador inteira vai numa única transação.
 void ssd1306_config(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_DISP | 0x00);
-  ssd1306_command(ssd, SET_MEM_ADDR);
-  ssd1306_command(ssd, 0x01);
-  ssd1306_command(ssd, SET_DISP_START_LINE | 0x00);
-  ssd1306_command(ssd, SET_SEG_REMAP | 0x01);
-  ssd1306_command(ssd, SET_MUX_RATIO);
-  ssd1306_command(ssd, HEIGHT - 1);
-  ssd1306_command(ssd, SET_COM_OUT_DIR | 0x08);
-  ssd1306_command(ssd, SET_DISP_OFFSET);
-  ssd1306_command(ssd, 0x00);
-  ssd1306_command(ssd, SET_COM_PIN_CFG);
-  ssd1306_command(ssd, 0x12);
-  ssd1306_command(ssd, SET_DISP_CLK_DIV);
-  ssd1306_command(ssd, 0x80);
-  ssd1306_command(ssd, SET_PRECHARGE);
-  ssd1306_command(ssd, 0xF1);
-  ssd1306_command(ssd, SET_VCOM_DESEL);
-  ssd1306_command(ssd, 0x30);
-  ssd1306_command(ssd, SET_CONTRAST);
-  ssd1306_command(ssd, 0xFF);
-  ssd1306_command(ssd, SET_ENTIRE_ON);
-  ssd1306_command(ssd, SET_NORM_INV);
-  ssd1306_command(ssd, SET_CHARGE_PUMP);
-  ssd1306_command(ssd, 0x14);
-  ssd1306_command(ssd, SET_DISP | 0x01);
+  ssd1306_cmdlist_t list;
+  ssd1306_cmdlist_init(&list);
+  SSD_BACKEND(ssd)->init(&list, SSD_WIDTH(ssd), SSD_HEIGHT(ssd), ssd->external_vcc);
+  ssd1306_cmdlist_send(ssd, &list);
 }
 
-void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
-  ssd->port_buffer[1] = command;
+// Aguarda o fim de qualquer transferência DMA e o esvaziamento da FIFO do I2C,
+// para que uma escrita bloqueante não interrompa um quadro ainda no barramento.
+void ssd1306_wait(ssd1306_t *ssd) {
+  while (ssd->dma_busy)
+    __wfe();
+  while (ssd1306_busy(ssd))
+    tight_loop_contents();
+}
+
+// Há uma transferência por DMA em curso ou bytes ainda saindo pela FIFO do I2C.
+bool ssd1306_busy(ssd1306_t *ssd) {
+  if (ssd->dma_busy)
+    return true;
+  i2c_hw_t *hw = i2c_get_hw(SSD_I2C(ssd));
+  return !(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+void ssd1306_cmdlist_init(ssd1306_cmdlist_t *list) {
+  list->bytes[0] = 0x00;
+  list->len = 1;
+}
+
+// Retorna false, sem acrescentar nada, se a lista não comporta os bytes.
+bool ssd1306_cmdlist_add(ssd1306_cmdlist_t *list, uint8_t command) {
+  return ssd1306_cmdlist_append(list, &command, 1);
+}
+
+bool ssd1306_cmdlist_append(ssd1306_cmdlist_t *list, const uint8_t *commands, size_t count) {
+  if (count > sizeof(list->bytes) - list->len)
+    return false;
+  memcpy(&list->bytes[list->len], commands, count);
+  list->len += count;
+  return true;
+}
+
+void ssd1306_cmdlist_send(ssd1306_t *ssd, const ssd1306_cmdlist_t *list) {
+  if (list->len < 2)
+    return;
+  ssd1306_wait(ssd);
   i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->port_buffer,
-    2,
+    SSD_I2C(ssd),
+    SSD_ADDRESS(ssd),
+    list->bytes,
+    list->len,
     false
   );
+  ssd->total_bytes += list->len;
 }
 
-void ssd1306_send_data(ssd1306_t *ssd) {
-  ssd1306_command(ssd, SET_COL_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->width - 1);
-  ssd1306_command(ssd, SET_PAGE_ADDR);
-  ssd1306_command(ssd, 0);
-  ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
-    ssd->i2c_port,
-    ssd->address,
-    ssd->ram_buffer,
-    ssd->bufsize,
-    false
+void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
+  ssd1306_cmdlist_t list;
+  ssd1306_cmdlist_init(&list);
+  ssd1306_cmdlist_add(&list, command);
+  ssd1306_cmdlist_send(ssd, &list);
+}
+
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t value) {
+  ssd1306_cmdlist_t list;
+  ssd1306_cmdlist_init(&list);
+  ssd1306_cmdlist_add(&list, SET_CONTRAST);
+  ssd1306_cmdlist_add(&list, value);
+  ssd1306_cmdlist_send(ssd, &list);
+}
+
+// Reduz a janela suja às colunas e páginas que realmente diferem do que o display já mostra, e anota
+// também as colunas alteradas em cada página (page_x0 > page_x1 em páginas intactas).
+// Retorna false se nada mudou.
+static bool ssd1306_diff_window(ssd1306_t *ssd, uint8_t *x0, uint8_t *x1, uint8_t *p0, uint8_t *p1,
+                                uint8_t *page_x0, uint8_t *page_x1) {
+  uint8_t nx0 = 0xFF, nx1 = 0, np0 = 0xFF, np1 = 0;
+
+  for (uint p = *p0; p <= *p1; ++p) {
+    page_x0[p] = 0xFF;
+    page_x1[p] = 0;
+  }
+
+  for (uint x = *x0; x <= *x1; ++x) {
+    const uint8_t *ram = &SSD_RAM(ssd)[1 + x * SSD_PAGES(ssd)];
+    const uint8_t *old = &SSD_SHADOW(ssd)[x * SSD_PAGES(ssd)];
+    for (uint p = *p0; p <= *p1; ++p) {
+      if (ram[p] != old[p]) {
+        if (x < nx0) nx0 = x;
+        nx1 = x;
+        if (p < np0) np0 = p;
+        if (p > np1) np1 = p;
+        if (x < page_x0[p]) page_x0[p] = x;
+        page_x1[p] = x;
+      }
+    }
+  }
+
+  if (nx0 > nx1)
+    return false;
+
+  *x0 = nx0;
+  *x1 = nx1;
+  *p0 = np0;
+  *p1 = np1;
+  return true;
+}
+
+// Cada palavra escrita em IC_DATA_CMD é um byte no barramento; o bit STOP no último encerra a transação.
+uint16_t *ssd1306_stream_cmdlist(uint16_t *out, const ssd1306_cmdlist_t *list) {
+  for (uint i = 0; i < list->len; ++i)
+    *out++ = list->bytes[i];
+  out[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  return out;
+}
+
+// Uma janela: o endereçamento do controlador (precedido dos comandos `lead`, na mesma transação) e os
+// dados na ordem que ele espera, montados pelo backend. O shadow é atualizado junto.
+static uint16_t *ssd1306_stage_window(ssd1306_t *ssd, uint16_t *out, const uint8_t *lead, uint8_t lead_count,
+                                      uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  const ssd1306_backend_t *backend = SSD_BACKEND(ssd);
+  out = backend->set_window(out, lead, lead_count, x0, x1, p0, p1);
+  out = backend->write_span(out, &SSD_RAM(ssd)[1], SSD_PAGES(ssd), x0, x1, p0, p1);
+
+  uint8_t span = p1 - p0 + 1;
+  for (uint x = x0; x <= x1; ++x)
+    memcpy(&SSD_SHADOW(ssd)[x * SSD_PAGES(ssd) + p0], &SSD_RAM(ssd)[1 + x * SSD_PAGES(ssd) + p0], span);
+  return out;
+}
+
+// Monta no buffer frontal `dst` o que mudou desde o último envio.
+// Retorna a quantidade de palavras montadas, ou 0 se não há nada a enviar.
+static uint16_t ssd1306_stage(ssd1306_t *ssd, uint16_t *dst) {
+  if (ssd->dirty_x0 > ssd->dirty_x1)
+    return 0;
+
+  uint8_t x0 = ssd->dirty_x0, x1 = ssd->dirty_x1;
+  uint8_t p0 = ssd->dirty_p0, p1 = ssd->dirty_p1;
+  ssd1306_clear_dirty(ssd);
+
+  // Mudanças distantes entre si (o segundo do relógio e a barra de progresso, por exemplo) fariam uma
+  // janela envolvente cheia de bytes iguais. Nesse caso vai uma janela por página alterada, cada uma
+  // com o endereçamento do backend e o byte de controle dos dados, se o total for menor. Controladores
+  // sem endereçamento vertical sempre recebem uma janela por página.
+  const ssd1306_backend_t *backend = SSD_BACKEND(ssd);
+  uint8_t page_x0[SSD1306_MAX_PAGES], page_x1[SSD1306_MAX_PAGES];
+  bool per_page = backend->paged;
+  if (ssd->shadow_valid) {
+    if (!ssd1306_diff_window(ssd, &x0, &x1, &p0, &p1, page_x0, page_x1))
+      return 0;
+
+    uint32_t single = backend->window_bytes + 1 + (x1 - x0 + 1) * (p1 - p0 + 1);
+    uint32_t split = 0;
+    for (uint p = p0; p <= p1; ++p)
+      if (page_x0[p] <= page_x1[p])
+        split += backend->window_bytes + 1 + page_x1[p] - page_x0[p] + 1;
+    per_page = per_page || split < single;
+  } else {
+    for (uint p = p0; p <= p1; ++p) {
+      page_x0[p] = x0;
+      page_x1[p] = x1;
+    }
+  }
+
+  uint16_t *out = dst;
+  if (per_page) {
+    for (uint p = p0; p <= p1; ++p)
+      if (page_x0[p] <= page_x1[p])
+        out = ssd1306_stage_window(ssd, out, NULL, 0, page_x0[p], page_x1[p], p, p);
+  } else {
+    out = ssd1306_stage_window(ssd, out, NULL, 0, x0, x1, p0, p1);
+  }
+
+  uint16_t len = out - dst;
+  ssd->frame_bytes = len;
+  ssd->total_bytes += len;
+  ssd->frames++;
+  ssd->shadow_valid = true;
+  return len;
+}
+
+// Monta `commands` e, se `page` existe, só as colunas dessa página que diferem do shadow, na mesma
+// transação de endereçamento. A região suja não muda: o próximo quadro completo confere o resto.
+static uint16_t ssd1306_stage_page(ssd1306_t *ssd, uint16_t *dst, uint8_t page, const uint8_t *commands, uint8_t count) {
+  uint8_t x0 = 0, x1 = SSD_WIDTH(ssd) - 1, p0 = page, p1 = page;
+  uint8_t page_x0[SSD1306_MAX_PAGES], page_x1[SSD1306_MAX_PAGES];
+  uint16_t *out = dst;
+
+  if (page < SSD_PAGES(ssd) && (!ssd->shadow_valid || ssd1306_diff_window(ssd, &x0, &x1, &p0, &p1, page_x0, page_x1))) {
+    out = ssd1306_stage_window(ssd, out, commands, count, x0, x1, page, page);
+  } else if (count) {
+    ssd1306_cmdlist_t list;
+    ssd1306_cmdlist_init(&list);
+    ssd1306_cmdlist_append(&list, commands, count);
+    out = ssd1306_stream_cmdlist(out, &list);
+  }
+
+  uint16_t len = out - dst;
+  ssd->frame_bytes = len;
+  ssd->total_bytes += len;
+  return len;
+}
+
+static void ssd1306_dma_start(ssd1306_t *ssd) {
+  i2c_hw_t *hw = i2c_get_hw(SSD_I2C(ssd));
+  if (hw->tar != SSD_ADDRESS(ssd)) {
+    hw->enable = 0;
+    hw->tar = SSD_ADDRESS(ssd);
+    hw->enable = 1;
+  }
+  (void) hw->clr_tx_abrt;
+
+  TRACE_BEGIN_ARG(TRACE_I2C, ssd->dma_len[ssd->dma_front]);
+  dma_channel_transfer_from_buffer_now(
+    ssd->dma_channel,
+    ssd->dma_buffer[ssd->dma_front],
+    ssd->dma_len[ssd->dma_front]
   );
 }
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
+// Fim da transferência: se há um quadro montado esperando, troca os buffers e inicia o próximo.
+static void ssd1306_dma_irq_handler(void) {
+  TRACE_BEGIN(TRACE_IRQ_DMA);
+  for (uint ch = 0; ch < NUM_DMA_CHANNELS; ++ch) {
+    ssd1306_t *ssd = dma_owner[ch];
+    if (!ssd || !dma_channel_get_irq0_status(ch))
+      continue;
+
+    dma_channel_acknowledge_irq0(ch);
+    TRACE_END(TRACE_I2C);
+    if (ssd->dma_pending) {
+      ssd->dma_front ^= 1;
+      ssd->dma_pending = false;
+      ssd1306_dma_start(ssd);
+    } else {
+      ssd->dma_busy = false;
+    }
+  }
+  __sev();
+  TRACE_END(TRACE_IRQ_DMA);
+}
+
+// Inicia a transferência do buffer `back`, ou a deixa pendente atrás da atual.
+static void ssd1306_dma_submit(ssd1306_t *ssd, uint8_t back, uint16_t len) {
+  ssd->dma_len[back] = len;
+
+  uint32_t irq = save_and_disable_interrupts();
+  if (ssd->dma_busy) {
+    ssd->dma_pending = true;
+  } else {
+    ssd->dma_front = back;
+    ssd->dma_busy = true;
+    ssd1306_dma_start(ssd);
+  }
+  restore_interrupts(irq);
+}
+
+// Monta o quadro no buffer livre e inicia a transferência por DMA sem bloquear.
+// Se já existe um quadro em transferência, o novo fica pendente e é iniciado pela interrupção.
+// Retorna false se os dois buffers estão ocupados; a região suja é mantida para o próximo envio.
+bool ssd1306_send_data_async(ssd1306_t *ssd) {
+  if (ssd->dma_pending)
+    return false;
+
+  uint8_t back = ssd->dma_front ^ 1;
+  uint16_t len = ssd1306_stage(ssd, ssd->dma_buffer[back]);
+  if (len)
+    ssd1306_dma_submit(ssd, back, len);
+  return true;
+}
+
+// Comandos soltos pelo mesmo caminho dos quadros, sem esperar o DMA: a sequência fica na fila atrás
+// do quadro em transferência. Retorna false se os dois buffers estão ocupados.
+bool ssd1306_send_commands_async(ssd1306_t *ssd, const uint8_t *commands, uint8_t count) {
+  return ssd1306_send_page_async(ssd, 0xFF, commands, count);
+}
+
+// Envia `commands` seguidos só das colunas alteradas de uma página. Com a linha inicial deslocada, é
+// assim que uma animação escreve a faixa que acabou de sair da tela sem reenviar o quadro.
+// Retorna false se os dois buffers estão ocupados.
+bool ssd1306_send_page_async(ssd1306_t *ssd, uint8_t page, const uint8_t *commands, uint8_t count) {
+  if (ssd->dma_pending)
+    return false;
+
+  uint8_t back = ssd->dma_front ^ 1;
+  uint16_t len = ssd1306_stage_page(ssd, ssd->dma_buffer[back], page, commands, count);
+  if (len)
+    ssd1306_dma_submit(ssd, back, len);
+  return true;
+}
+
+void ssd1306_send_data(ssd1306_t *ssd) {
+  while (!ssd1306_send_data_async(ssd))
+    ssd1306_wait(ssd);
+  ssd1306_wait(ssd);
+}
+
+// Vídeo inverso feito pelo controlador: a RAM não muda, são 2 bytes no barramento.
+void ssd1306_invert(ssd1306_t *ssd, bool invert) {
+  ssd1306_command(ssd, SET_NORM_INV | invert);
+}
+
+// Rolagem contínua das páginas p0..p1, feita pelo controlador sem nenhum byte por passo. `interval` é o
+// código de 3 bits do intervalo entre passos (0 = 5 quadros ... 7 = 2 quadros); com `vertical` > 0,
+// a tela inteira também sobe essa quantidade de linhas por passo. A rolagem move os dados na GDDRAM
+// e escrever na RAM com ela ativa dá resultado indefinido: pare com ssd1306_scroll_stop antes de enviar.
+// Sem efeito em controladores sem rolagem (SH1106).
+void ssd1306_scroll(ssd1306_t *ssd, bool left, uint8_t p0, uint8_t p1, uint8_t interval, uint8_t vertical) {
+  if (!SSD_BACKEND(ssd)->scroll)
+    return;
+  ssd1306_cmdlist_t list;
+  ssd1306_cmdlist_init(&list);
+  ssd1306_cmdlist_add(&list, SET_SCROLL_OFF);
+  if (vertical) {
+    const uint8_t scroll[] = {
+      SET_VSCROLL_AREA, 0, SSD_HEIGHT(ssd),
+      left ? SET_SCROLL_VLEFT : SET_SCROLL_VRIGHT, 0x00, p0, interval & 0x07, p1, vertical % SSD_HEIGHT(ssd),
+    };
+    ssd1306_cmdlist_append(&list, scroll, sizeof(scroll));
+  } else {
+    const uint8_t scroll[] = { left ? SET_SCROLL_LEFT : SET_SCROLL_RIGHT, 0x00, p0, interval & 0x07, p1, 0x00, 0xFF };
+    ssd1306_cmdlist_append(&list, scroll, sizeof(scroll));
+  }
+  ssd1306_cmdlist_add(&list, SET_SCROLL_ON);
+  ssd1306_cmdlist_send(ssd, &list);
+}
+
+// Depois de uma rolagem o conteúdo da GDDRAM não corresponde mais ao shadow: o próximo envio é completo.
+void ssd1306_scroll_stop(ssd1306_t *ssd) {
+  if (!SSD_BACKEND(ssd)->scroll)
+    return;
+  ssd1306_command(ssd, SET_SCROLL_OFF);
+  ssd->shadow_valid = false;
+  ssd1306_mark_dirty_clip(ssd, 0, 0, SSD_WIDTH(ssd) - 1, SSD_HEIGHT(ssd) - 1);
+}
+
+// Escrita direta no buffer, sem marcar a região suja. As primitivas marcam a área desenhada uma única vez.
+// O buffer segue o modo de endereçamento vertical: cada coluna ocupa `pages` bytes consecutivos.
+static inline void ssd1306_put(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  if (x >= SSD_WIDTH(ssd) || y >= SSD_HEIGHT(ssd))
+    return;
+  uint16_t index = (y >> 3) + x * SSD_PAGES(ssd) + 1;
   uint8_t pixel = (y & 0b111);
   if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
+    SSD_RAM(ssd)[index] |= (1 << pixel);
   else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+    SSD_RAM(ssd)[index] &= ~(1 << pixel);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
+static inline void ssd1306_apply_mask(uint8_t *byte, uint8_t mask, bool value) {
+  if (value)
+    *byte |= mask;
+  else
+    *byte &= ~mask;
+}
 
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
-    }
+// Trecho horizontal: a máscara da página é calculada uma vez e aplicada coluna a coluna.
+static void ssd1306_hspan(ssd1306_t *ssd, int x0, int x1, int y, bool value) {
+  if (y < 0 || y >= SSD_HEIGHT(ssd))
+    return;
+  if (x0 < 0) x0 = 0;
+  if (x1 >= SSD_WIDTH(ssd)) x1 = SSD_WIDTH(ssd) - 1;
+  if (x0 > x1)
+    return;
+
+  uint8_t stride = SSD_PAGES(ssd);
+  uint8_t *byte = &SSD_RAM(ssd)[1 + x0 * stride + (y >> 3)];
+  uint8_t mask = 1u << (y & 0b111);
+  if (value) {
+    for (int x = x0; x <= x1; ++x, byte += stride)
+      *byte |= mask;
+  } else {
+    mask = ~mask;
+    for (int x = x0; x <= x1; ++x, byte += stride)
+      *byte &= mask;
+  }
 }
 
+// Trecho vertical: bytes inteiros nas páginas completas e máscaras apenas na primeira e na última.
+static void ssd1306_vspan(ssd1306_t *ssd, int x, int y0, int y1, bool value) {
+  if (x < 0 || x >= SSD_WIDTH(ssd))
+    return;
+  if (y0 < 0) y0 = 0;
+  if (y1 >= SSD_HEIGHT(ssd)) y1 = SSD_HEIGHT(ssd) - 1;
+  if (y0 > y1)
+    return;
 
+  uint8_t *column = &SSD_RAM(ssd)[1 + x * SSD_PAGES(ssd)];
+  uint8_t p0 = y0 >> 3, p1 = y1 >> 3;
+  uint8_t first = (uint8_t) (0xFF << (y0 & 0b111));
+  uint8_t last = 0xFF >> (7 - (y1 & 0b111));
 
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
+  if (p0 == p1) {
+    ssd1306_apply_mask(&column[p0], first & last, value);
+    return;
   }
 
+  ssd1306_apply_mask(&column[p0], first, value);
+  uint8_t byte = value ? 0xFF : 0x00;
+  for (uint8_t p = p0 + 1; p < p1; ++p)
+    column[p] = byte;
+  ssd1306_apply_mask(&column[p1], last, value);
+}
+
+void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
+  ssd1306_put(ssd, x, y, value);
+  ssd1306_mark_dirty_clip(ssd, x, y, x, y);
+}
+
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  memset(&SSD_RAM(ssd)[1], value ? 0xFF : 0x00, SSD_BUFSIZE(ssd) - 1);
+  ssd1306_mark_dirty_clip(ssd, 0, 0, SSD_WIDTH(ssd) - 1, SSD_HEIGHT(ssd) - 1);
+}
+
+void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
+  if (!width || !height)
+    return;
+
+  int right = left + width - 1;
+  int bottom = top + height - 1;
+
   if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+    for (int x = left; x <= right && x < SSD_WIDTH(ssd); ++x)
+      ssd1306_vspan(ssd, x, top, bottom, value);
+  } else {
+    ssd1306_hspan(ssd, left, right, top, value);
+    ssd1306_hspan(ssd, left, right, bottom, value);
+    ssd1306_vspan(ssd, left, top, bottom, value);
+    ssd1306_vspan(ssd, right, top, bottom, value);
   }
+  ssd1306_mark_dirty_clip(ssd, left, top, right, bottom);
 }
 
 void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
@@ -123,8 +573,10 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 
     int err = dx - dy;
 
+    ssd1306_mark_dirty_clip(ssd, x0 < x1 ? x0 : x1, y0 < y1 ? y0 : y1, x0 < x1 ? x1 : x0, y0 < y1 ? y1 : y0);
+
     while (true) {
-        ssd1306_pixel(ssd, x0, y0, value); // Desenha o pixel atual
+        ssd1306_put(ssd, x0, y0, value); // Desenha o pixel atual
 
         if (x0 == x1 && y0 == y1) break; // Termina quando alcança o ponto final
 
@@ -144,40 +596,84 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 
 
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_hspan(ssd, x0, x1, y, value);
+  ssd1306_mark_dirty_clip(ssd, x0, y, x1, y);
 }
 
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+  ssd1306_vspan(ssd, x, y0, y1, value);
+  ssd1306_mark_dirty_clip(ssd, x, y0, x, y1);
 }
 
-// Função para desenhar um caractere
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+// Copia as colunas de um glifo para o buffer e completa com colunas vazias até `columns`: o glifo é
+// opaco em toda a largura, então redesenhar por cima não exige apagar antes. O bitmap já está no
+// formato de uma página do buffer; com `y` múltiplo de 8 cada byte é copiado direto para a página,
+// caso contrário é dividido em dois bytes deslocados e mascarados.
+static void ssd1306_blit(ssd1306_t *ssd, const font_t *font, const font_glyph_t *glyph, uint8_t x, uint8_t y,
+                         uint8_t columns)
 {
-  uint16_t index = 0;
-  char ver=c;
-  if (c >= 'A' && c <= 'Z') {
-    index = (c - 'A' + 11) * 8; // Para letras maiúsculas
-  }
+  if (x >= SSD_WIDTH(ssd) || y >= SSD_HEIGHT(ssd) || !columns)
+    return;
+  if (columns > SSD_WIDTH(ssd) - x)
+    columns = SSD_WIDTH(ssd) - x;
 
-  else if (c >= 'a' && c <= 'z') {
-    index = (c - 'a' + 37) * 8; // Para letras minúsculas
-  }
+  uint8_t stored = glyph->width < columns ? glyph->width : columns;
+  const uint8_t *src = &font->bitmap[glyph->offset];
+  uint8_t page = y >> 3;
+  uint8_t shift = y & 0b111;
+  uint8_t mask_lo = (uint8_t) (0xFF << shift);
+  uint8_t mask_hi = ~mask_lo;
 
-  else  if (c >= '0' && c <= '9') {
-    index = (c - '0' + 1) * 8; // Adiciona o deslocamento necessário
-  }
-  
-  for (uint8_t i = 0; i < 8; ++i)
-  {
-    uint8_t line = font[index + i];
-    for (uint8_t j = 0; j < 8; ++j)
-    {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
+  for (uint8_t row = 0; row < font->pages && page + row < SSD_PAGES(ssd); ++row, src += glyph->width) {
+    uint8_t *dst = &SSD_RAM(ssd)[1 + x * SSD_PAGES(ssd) + page + row];
+    uint8_t i = 0;
+    if (!shift) {
+      for (; i < stored; ++i, dst += SSD_PAGES(ssd))
+        *dst = src[i];
+      for (; i < columns; ++i, dst += SSD_PAGES(ssd))
+        *dst = 0;
+    } else {
+      bool has_hi = page + row + 1 < SSD_PAGES(ssd);
+      for (; i < columns; ++i, dst += SSD_PAGES(ssd)) {
+        uint8_t bits = i < stored ? src[i] : 0;
+        dst[0] = (dst[0] & ~mask_lo) | (uint8_t) (bits << shift);
+        if (has_hi)
+          dst[1] = (dst[1] & ~mask_hi) | (bits >> (8 - shift));
+      }
     }
   }
+  ssd1306_mark_dirty_clip(ssd, x, y, x + columns - 1, y + font->pages * 8 - 1);
+}
+
+// Função para desenhar um caractere numa célula de 8x8
+void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+{
+  ssd1306_blit(ssd, &font_8x8, font_glyph(&font_8x8, c), x, y, 8);
+}
+
+// Desenha um caractere de `font`, opaco na largura de avanço. Retorna o avanço.
+uint8_t ssd1306_draw_glyph(ssd1306_t *ssd, const font_t *font, char c, uint8_t x, uint8_t y)
+{
+  const font_glyph_t *glyph = font_glyph(font, c);
+  ssd1306_blit(ssd, font, glyph, x, y, glyph->advance);
+  return glyph->advance;
+}
+
+// Desenha um texto com a largura própria de cada glifo, numa linha só. Retorna a coluna seguinte ao texto.
+uint16_t ssd1306_draw_text(ssd1306_t *ssd, const font_t *font, const char *str, uint8_t x, uint8_t y)
+{
+  uint16_t at = x;
+  while (*str && at < SSD_WIDTH(ssd))
+    at += ssd1306_draw_glyph(ssd, font, *str++, at, y);
+  return at;
+}
+
+uint16_t ssd1306_text_width(const font_t *font, const char *str)
+{
+  uint16_t width = 0;
+  while (*str)
+    width += font_glyph(font, *str++)->advance;
+  return width;
 }
 
 // Função para desenhar uma string
@@ -187,12 +683,12 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
   {
     ssd1306_draw_char(ssd, *str++, x, y);
     x += 8;
-    if (x + 8 >= ssd->width)
+    if (x + 8 >= SSD_WIDTH(ssd))
     {
       x = 0;
       y += 8;
     }
-    if (y + 8 >= ssd->height)
+    if (y + 8 >= SSD_HEIGHT(ssd))
     {
       break;
     }
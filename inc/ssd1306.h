@@ -1,9 +1,36 @@
+#ifndef SSD1306_H
+#define SSD1306_H
+
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "font.h"
+
+// Painel da placa: 128x64 no i2c1, endereço 0x3C, controlador SSD1306. Os módulos de 128x32 e com SH1106
+// da frota são escolhidos na compilação (POMODORO_PANEL no CMake), que define SSD1306_PANEL_HEIGHT e
+// SSD1306_PANEL_BACKEND. Com SSD1306_STATIC o driver é especializado para estes valores na compilação
+// (buffers estáticos, limites constantes) e ssd1306_init confere os argumentos.
+#ifndef SSD1306_PANEL_HEIGHT
+#define SSD1306_PANEL_HEIGHT 64
+#endif
+#ifndef SSD1306_PANEL_BACKEND
+#define SSD1306_PANEL_BACKEND ssd1306_backend_ssd1306
+#endif
 
 #define WIDTH 128
-#define HEIGHT 64
+#define HEIGHT SSD1306_PANEL_HEIGHT
+#define SSD1306_I2C i2c1
+#define SSD1306_ADDRESS 0x3C
+#define SSD1306_BACKEND (&SSD1306_PANEL_BACKEND)
+#define SSD1306_MAX_PAGES 8                           // Maior altura dos controladores suportados, em páginas
+
+#ifndef SSD1306_STATIC
+#define SSD1306_STATIC 0
+#endif
+
+#define SSD1306_BUFSIZE (WIDTH * HEIGHT / 8 + 1)      // Quadro e o byte de controle 0x40
+// Pior caso de um envio: o quadro com uma janela por página, cada uma com até 8 bytes de comandos e controle
+#define SSD1306_DMA_WORDS (HEIGHT / 8 * 8 + SSD1306_BUFSIZE)
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -22,22 +49,90 @@ typedef enum {
   SET_DISP_CLK_DIV = 0xD5,
   SET_PRECHARGE = 0xD9,
   SET_VCOM_DESEL = 0xDB,
-  SET_CHARGE_PUMP = 0x8D
+  SET_CHARGE_PUMP = 0x8D,
+  SET_SCROLL_RIGHT = 0x26,    // Rolagem horizontal contínua das páginas indicadas
+  SET_SCROLL_LEFT = 0x27,
+  SET_SCROLL_VRIGHT = 0x29,   // Horizontal e vertical ao mesmo tempo
+  SET_SCROLL_VLEFT = 0x2A,
+  SET_SCROLL_OFF = 0x2E,
+  SET_SCROLL_ON = 0x2F,
+  SET_VSCROLL_AREA = 0xA3     // Linhas fixas no topo e linhas que rolam na vertical
 } ssd1306_command_t;
 
+#define SSD1306_CMDLIST_MAX 32
+
+// Sequência de comandos enviada numa única transação I2C: um byte de controle 0x00 (Co = 0, D/C = 0)
+// seguido de todos os comandos e parâmetros, em vez de um par controle/comando por transação.
 typedef struct {
+  uint8_t bytes[1 + SSD1306_CMDLIST_MAX]; // bytes[0] é o byte de controle
+  uint8_t len;
+} ssd1306_cmdlist_t;
+
+// Controlador do painel. O buffer e as primitivas de desenho são os mesmos para todos; o backend diz como
+// inicializar o controlador, como posicionar a escrita numa janela e em que ordem os bytes da janela vão,
+// e o envio escolhe a estratégia mais barata com o custo de endereçamento declarado aqui. As operações
+// montam palavras para o registrador IC_DATA_CMD do I2C (bit STOP no último byte de cada transação).
+typedef struct {
+  const char *name;
+  uint8_t window_bytes;     // Bytes de endereçamento de uma janela, com o byte de controle
+  bool paged;               // Sem endereçamento vertical: cada janela cobre uma página só
+  bool scroll;              // Tem a rolagem contínua (0x26/0x27/0x29/0x2A)
+  // Sequência de inicialização para a geometria do painel
+  void (*init)(ssd1306_cmdlist_t *list, uint8_t width, uint8_t height, bool external_vcc);
+  // Comandos `lead` seguidos do endereçamento da janela, numa transação
+  uint16_t *(*set_window)(uint16_t *out, const uint8_t *lead, uint8_t lead_count,
+                          uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+  // Dados da janela de `frame` (coluna a coluna, `pages` bytes por coluna), na ordem em que o controlador
+  // avança o endereço
+  uint16_t *(*write_span)(uint16_t *out, const uint8_t *frame, uint8_t pages,
+                          uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+} ssd1306_backend_t;
+
+extern const ssd1306_backend_t ssd1306_backend_ssd1306;   // Endereçamento vertical, janelas de várias páginas
+extern const ssd1306_backend_t ssd1306_backend_sh1106;    // RAM de 132 colunas, escrita página a página
+
+typedef struct {
+  const ssd1306_backend_t *backend;
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
-  uint8_t port_buffer[2];
+  uint8_t *shadow;          // Cópia do conteúdo já enviado ao display (sem o byte de controle)
+  uint8_t dirty_x0, dirty_x1, dirty_p0, dirty_p1; // Região alterada desde o último envio (vazia se x0 > x1)
+  bool shadow_valid;        // Falso até o primeiro envio completo: a RAM do display é desconhecida
+  uint32_t frame_bytes;     // Bytes escritos no barramento no último quadro (comandos + dados)
+  uint32_t total_bytes;     // Bytes acumulados desde a inicialização
+  uint32_t frames;          // Quadros efetivamente enviados
+  uint16_t *dma_buffer[2];  // Buffers frontais: quadro codificado para o registrador IC_DATA_CMD
+  uint16_t dma_len[2];
+  uint8_t dma_front;        // Buffer em transferência (ou o último transferido)
+  int dma_channel;
+  volatile bool dma_busy;   // Há uma transferência DMA em andamento
+  volatile bool dma_pending; // O outro buffer já tem um quadro aguardando o fim da transferência atual
+  uint32_t heap_bytes;      // Alocados por ssd1306_init (0 com SSD1306_STATIC)
 } ssd1306_t;
 
-void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+void ssd1306_init(ssd1306_t *ssd, const ssd1306_backend_t *backend, uint8_t width, uint8_t height, bool external_vcc,
+                  uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
+void ssd1306_contrast(ssd1306_t *ssd, uint8_t value);
+void ssd1306_cmdlist_init(ssd1306_cmdlist_t *list);
+bool ssd1306_cmdlist_add(ssd1306_cmdlist_t *list, uint8_t command);
+bool ssd1306_cmdlist_append(ssd1306_cmdlist_t *list, const uint8_t *commands, size_t count);
+void ssd1306_cmdlist_send(ssd1306_t *ssd, const ssd1306_cmdlist_t *list);
+uint16_t *ssd1306_stream_cmdlist(uint16_t *out, const ssd1306_cmdlist_t *list);
 void ssd1306_send_data(ssd1306_t *ssd);
+bool ssd1306_send_data_async(ssd1306_t *ssd);
+bool ssd1306_send_commands_async(ssd1306_t *ssd, const uint8_t *commands, uint8_t count);
+bool ssd1306_send_page_async(ssd1306_t *ssd, uint8_t page, const uint8_t *commands, uint8_t count);
+void ssd1306_invert(ssd1306_t *ssd, bool invert);
+void ssd1306_scroll(ssd1306_t *ssd, bool left, uint8_t p0, uint8_t p1, uint8_t interval, uint8_t vertical);
+void ssd1306_scroll_stop(ssd1306_t *ssd);
+bool ssd1306_busy(ssd1306_t *ssd);
+void ssd1306_wait(ssd1306_t *ssd);
+void ssd1306_mark_dirty(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1);
 
 void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
@@ -46,4 +141,9 @@ void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1
 void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
 void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
 void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
+uint8_t ssd1306_draw_glyph(ssd1306_t *ssd, const font_t *font, char c, uint8_t x, uint8_t y);
+uint16_t ssd1306_draw_text(ssd1306_t *ssd, const font_t *font, const char *str, uint8_t x, uint8_t y);
+uint16_t ssd1306_text_width(const font_t *font, const char *str);
+
+#endif
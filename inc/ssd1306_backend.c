@@ -0,0 +1,127 @@
+#include "ssd1306.h"
+
+// Controladores suportados pelo driver (ver ssd1306_backend_t em ssd1306.h).
+
+// SSD1306: endereçamento vertical (0x01), então uma janela pode cobrir várias páginas e o controlador a
+// percorre coluna a coluna, na mesma ordem do buffer. 128x64 e 128x32 mudam só o multiplex e os pinos COM.
+static void ssd1306_init_sequence(ssd1306_cmdlist_t *list, uint8_t width, uint8_t height, bool external_vcc) {
+  const uint8_t sequence[] = {
+    SET_DISP | 0x00,
+    SET_SCROLL_OFF,           // Um reset só do RP2040 pode deixar uma rolagem ativa no controlador
+    SET_MEM_ADDR, 0x01,
+    SET_DISP_START_LINE | 0x00,
+    SET_SEG_REMAP | 0x01,
+    SET_MUX_RATIO, height - 1,
+    SET_COM_OUT_DIR | 0x08,
+    SET_DISP_OFFSET, 0x00,
+    SET_COM_PIN_CFG, height == 32 ? 0x02 : 0x12,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_PRECHARGE, external_vcc ? 0x22 : 0xF1,
+    SET_VCOM_DESEL, 0x30,
+    SET_CONTRAST, 0xFF,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_CHARGE_PUMP, external_vcc ? 0x10 : 0x14,
+    SET_DISP | 0x01,
+  };
+  ssd1306_cmdlist_append(list, sequence, sizeof(sequence));
+}
+
+static uint16_t *ssd1306_set_window(uint16_t *out, const uint8_t *lead, uint8_t lead_count,
+                                    uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  const uint8_t window[] = { SET_COL_ADDR, x0, x1, SET_PAGE_ADDR, p0, p1 };
+  ssd1306_cmdlist_t list;
+  ssd1306_cmdlist_init(&list);
+  ssd1306_cmdlist_append(&list, lead, lead_count);
+  ssd1306_cmdlist_append(&list, window, sizeof(window));
+  return ssd1306_stream_cmdlist(out, &list);
+}
+
+// Os bytes de cada coluna da janela são consecutivos no buffer
+static uint16_t *ssd1306_write_span(uint16_t *out, const uint8_t *frame, uint8_t pages,
+                                    uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  *out++ = 0x40;
+  uint8_t span = p1 - p0 + 1;
+  for (uint x = x0; x <= x1; ++x) {
+    const uint8_t *src = &frame[x * pages + p0];
+    for (uint8_t i = 0; i < span; ++i)
+      *out++ = src[i];
+  }
+  out[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  return out;
+}
+
+const ssd1306_backend_t ssd1306_backend_ssd1306 = {
+  .name = "ssd1306",
+  .window_bytes = 7,
+  .paged = false,
+  .scroll = true,
+  .init = ssd1306_init_sequence,
+  .set_window = ssd1306_set_window,
+  .write_span = ssd1306_write_span,
+};
+
+// SH1106: RAM de 132 colunas com o painel de 128 centralizado (coluna 2) e só o endereçamento por página:
+// cada janela é uma página, posicionada com 3 bytes (página, nibble baixo e alto da coluna) em vez dos 6
+// da janela do SSD1306. Não tem rolagem contínua; linha inicial e vídeo inverso são iguais.
+#define SH1106_COLUMN_OFFSET 2
+#define SH1106_SET_PAGE 0xB0
+#define SH1106_SET_COL_LOW 0x00
+#define SH1106_SET_COL_HIGH 0x10
+#define SH1106_SET_DC_DC 0xAD
+
+static void sh1106_init_sequence(ssd1306_cmdlist_t *list, uint8_t width, uint8_t height, bool external_vcc) {
+  const uint8_t sequence[] = {
+    SET_DISP | 0x00,
+    SET_DISP_CLK_DIV, 0x80,
+    SET_MUX_RATIO, height - 1,
+    SET_DISP_OFFSET, 0x00,
+    SET_DISP_START_LINE | 0x00,
+    SH1106_SET_DC_DC, external_vcc ? 0x8A : 0x8B,
+    SET_SEG_REMAP | 0x01,
+    SET_COM_OUT_DIR | 0x08,
+    SET_COM_PIN_CFG, height == 32 ? 0x02 : 0x12,
+    SET_CONTRAST, 0xFF,
+    SET_PRECHARGE, external_vcc ? 0x22 : 0x1F,
+    SET_VCOM_DESEL, 0x40,
+    SET_ENTIRE_ON,
+    SET_NORM_INV,
+    SET_DISP | 0x01,
+  };
+  ssd1306_cmdlist_append(list, sequence, sizeof(sequence));
+}
+
+// O envio garante p0 == p1
+static uint16_t *sh1106_set_window(uint16_t *out, const uint8_t *lead, uint8_t lead_count,
+                                   uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  uint8_t column = x0 + SH1106_COLUMN_OFFSET;
+  const uint8_t window[] = {
+    SH1106_SET_PAGE | p0, SH1106_SET_COL_LOW | (column & 0x0F), SH1106_SET_COL_HIGH | (column >> 4),
+  };
+  ssd1306_cmdlist_t list;
+  ssd1306_cmdlist_init(&list);
+  ssd1306_cmdlist_append(&list, lead, lead_count);
+  ssd1306_cmdlist_append(&list, window, sizeof(window));
+  return ssd1306_stream_cmdlist(out, &list);
+}
+
+// Uma página: o byte da página em cada coluna, com passo `pages` no buffer
+static uint16_t *sh1106_write_span(uint16_t *out, const uint8_t *frame, uint8_t pages,
+                                   uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+  *out++ = 0x40;
+  const uint8_t *src = &frame[x0 * pages + p0];
+  for (uint x = x0; x <= x1; ++x, src += pages)
+    *out++ = *src;
+  out[-1] |= I2C_IC_DATA_CMD_STOP_BITS;
+  return out;
+}
+
+const ssd1306_backend_t ssd1306_backend_sh1106 = {
+  .name = "sh1106",
+  .window_bytes = 4,
+  .paged = true,
+  .scroll = false,
+  .init = sh1106_init_sequence,
+  .set_window = sh1106_set_window,
+  .write_span = sh1106_write_span,
+};
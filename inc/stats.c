@@ -0,0 +1,73 @@
+#include "stats.h"
+#include "link.h"
+
+_Static_assert(sizeof(stats_t) + LINK_OVERHEAD <= LINK_PACKET, "o registro deve caber num pacote USB");
+
+static stats_t stats;
+static bool stats_dirty;            // Mudou desde o último envio
+static uint64_t stats_due_us;       // Próximo envio periódico
+
+void stats_init(uint16_t boot) {
+  stats = (stats_t) { .boot = boot, .version = STATS_VERSION };
+  stats_dirty = true;
+  stats_due_us = 0;
+}
+
+static stats_streak_t *stats_streak(const uint8_t *preset) {
+  return preset[1] < STATS_PRESETS ? &stats.streaks[preset[1]] : NULL;
+}
+
+// Chamada no fim de cada fase, com a sessão já na fase seguinte (ou liberada, no fim do último intervalo).
+void stats_phase_end(const session_t *session, uint8_t phase) {
+  if (phase == PHASE_WORK) {
+    stats.focus_s += session->work_minutes * 60u;
+  } else {
+    stats.cycles_completed++;
+    if (!session->used) {
+      stats.sessions_completed++;
+      stats_streak_t *streak = stats_streak(session->preset);
+      if (streak && ++streak->current > streak->best)
+        streak->best = streak->current;
+    }
+  }
+  stats_dirty = true;
+}
+
+// Sessão salva descartada na retomada: o trabalho já feito conta como foco, o resto como abortado.
+void stats_session_aborted(const session_snapshot_t *snapshot) {
+  if (snapshot->phase == PHASE_WORK) {
+    uint32_t length = snapshot->work_minutes * 60u;
+    stats.focus_s += length > snapshot->phase_left ? length - snapshot->phase_left : 0;
+  }
+  stats.cycles_aborted += snapshot->cycles_remaining;
+  stats.sessions_aborted++;
+  stats_streak_t *streak = stats_streak(snapshot->preset);
+  if (streak)
+    streak->current = 0;
+  stats_dirty = true;
+}
+
+// Envia o registro agora. Retorna false se não havia terminal; nesse caso ele segue marcado para envio.
+bool stats_send(void) {
+  uint64_t now = time_us_64();
+  stats.uptime_s = (uint32_t) (now / 1000000);
+  stats.active = sessions_active();
+  stats_due_us = now + STATS_PERIOD_S * 1000000ull;
+  if (!link_send(LINK_STATS, &stats, sizeof(stats)))
+    return false;
+  stats.seq++;
+  stats_dirty = false;
+  return true;
+}
+
+// Chamada no laço principal, depois do tratamento dos eventos: o registro sai uma vez por lote de
+// mudanças, e o tick de um segundo garante que o laço passe aqui para o envio periódico. Sem terminal,
+// as mudanças se acumulam e saem juntas quando ele conectar.
+void stats_service(void) {
+  if ((stats_dirty || time_us_64() >= stats_due_us) && link_connected())
+    stats_send();
+}
+
+const stats_t *stats_get(void) {
+  return &stats;
+}
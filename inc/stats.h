@@ -0,0 +1,48 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "pico/stdlib.h"
+#include "session.h"
+
+// Totais de produtividade desde o boot, atualizados a cada fim de fase, sem percorrer o histórico.
+//
+// - Foco: segundos de trabalho cumpridos, inclusive a parte já feita de uma sessão descartada.
+// - Ciclos: concluídos no fim de cada intervalo; os que faltavam nas sessões descartadas contam como abortados.
+// - Sequências: por predefinição de tempo de trabalho do menu, quantas sessões seguidas foram até o fim
+//   sem um descarte no meio, e a maior sequência desde o boot.
+//
+// O registro vai pela USB (inc/link.c) como está na RAM, a cada mudança e a cada STATS_PERIOD_S, para que
+// um terminal que acabou de conectar receba o estado. `boot` separa os registros de boots diferentes.
+
+#define STATS_PRESETS 6             // Opções de tempo de trabalho do menu
+#define STATS_PERIOD_S 60
+
+typedef struct {
+  uint16_t current;                 // Sessões concluídas seguidas
+  uint16_t best;
+} stats_streak_t;
+
+typedef struct {
+  uint32_t seq;                     // Registros enviados antes deste, para o receptor notar perdas
+  uint32_t uptime_s;
+  uint16_t boot;                    // Boot contado pelo histórico
+  uint8_t version;                  // STATS_VERSION
+  uint8_t active;                   // Sessões em andamento
+  uint32_t focus_s;
+  uint32_t cycles_completed;
+  uint32_t cycles_aborted;
+  uint32_t sessions_completed;
+  uint32_t sessions_aborted;
+  stats_streak_t streaks[STATS_PRESETS];
+} stats_t;
+
+#define STATS_VERSION 1
+
+void stats_init(uint16_t boot);
+void stats_phase_end(const session_t *session, uint8_t phase);
+void stats_session_aborted(const session_snapshot_t *snapshot);
+void stats_service(void);
+bool stats_send(void);
+const stats_t *stats_get(void);
+
+#endif
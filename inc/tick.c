@@ -0,0 +1,129 @@
+#include "tick.h"
+#include "hardware/timer.h"
+#include "hardware/sync.h"
+#include "trace.h"
+
+enum { TICK_STOPPED, TICK_RUNNING, TICK_PAUSED };
+
+static int tick_alarm = -1;
+static volatile uint8_t tick_state = TICK_STOPPED;
+static tick_callback_t tick_callback;
+static void *tick_user_data;
+static uint32_t tick_period_us;
+static uint64_t tick_base_us;     // Prazo do tick 0, adiado a cada retomada pelo tempo em pausa
+static uint64_t tick_paused_at;
+static uint32_t tick_count;       // Ticks entregues desde tick_start
+static tick_stats_t tick_stats;
+
+static inline uint64_t tick_deadline(uint32_t n) {
+  return tick_base_us + (uint64_t) n * tick_period_us;
+}
+
+// Entrega o próximo tick e registra o atraso em relação ao prazo dele.
+static void tick_fire(bool catch_up) {
+  uint64_t now = time_us_64();
+  uint64_t deadline = tick_deadline(tick_count + 1);
+  uint32_t late = now > deadline ? (uint32_t) (now - deadline) : 0;
+
+  tick_stats.ticks++;
+  tick_stats.late_sum_us += late;
+  if (late > tick_stats.late_max_us)
+    tick_stats.late_max_us = late;
+  if (catch_up)
+    tick_stats.catch_up++;
+
+  if (!tick_callback(++tick_count, tick_user_data))
+    tick_state = TICK_STOPPED;
+}
+
+// Arma o alarme no prazo do próximo tick. hardware_alarm_set_target não arma um alarme
+// cujo prazo já passou (ou passa durante a escrita): esses ticks são entregues aqui mesmo.
+static void tick_schedule(void) {
+  while (tick_state == TICK_RUNNING) {
+    if (!hardware_alarm_set_target(tick_alarm, from_us_since_boot(tick_deadline(tick_count + 1))))
+      return;
+    tick_fire(true);
+  }
+}
+
+static void tick_alarm_callback(uint alarm_num) {
+  (void) alarm_num;
+  if (tick_state != TICK_RUNNING)
+    return;
+  TRACE_BEGIN(TRACE_TICK);
+  tick_fire(false);
+  tick_schedule();
+  TRACE_END(TRACE_TICK);
+}
+
+void tick_init(void) {
+  if (tick_alarm >= 0)
+    return;
+  tick_alarm = hardware_alarm_claim_unused(true);
+  hardware_alarm_set_callback(tick_alarm, tick_alarm_callback);
+}
+
+// Começa a contar a partir de agora; o primeiro tick chega depois de um período.
+void tick_start(uint32_t period_us, tick_callback_t callback, void *user_data) {
+  uint32_t irq = save_and_disable_interrupts();
+  hardware_alarm_cancel(tick_alarm);
+  tick_callback = callback;
+  tick_user_data = user_data;
+  tick_period_us = period_us;
+  tick_count = 0;
+  tick_base_us = time_us_64();
+  tick_state = TICK_RUNNING;
+  tick_schedule();
+  restore_interrupts(irq);
+}
+
+void tick_stop(void) {
+  uint32_t irq = save_and_disable_interrupts();
+  tick_state = TICK_STOPPED;
+  hardware_alarm_cancel(tick_alarm);
+  restore_interrupts(irq);
+}
+
+// A fração de período já decorrida é preservada: a retomada só adia os prazos pelo tempo em pausa.
+void tick_pause(void) {
+  uint32_t irq = save_and_disable_interrupts();
+  if (tick_state == TICK_RUNNING) {
+    hardware_alarm_cancel(tick_alarm);
+    tick_paused_at = time_us_64();
+    tick_state = TICK_PAUSED;
+    tick_stats.pauses++;
+  }
+  restore_interrupts(irq);
+}
+
+void tick_resume(void) {
+  uint32_t irq = save_and_disable_interrupts();
+  if (tick_state == TICK_PAUSED) {
+    uint64_t paused = time_us_64() - tick_paused_at;
+    tick_base_us += paused;
+    tick_stats.paused_us += paused;
+    tick_state = TICK_RUNNING;
+    tick_schedule();
+  }
+  restore_interrupts(irq);
+}
+
+bool tick_running(void) {
+  return tick_state != TICK_STOPPED;
+}
+
+bool tick_paused(void) {
+  return tick_state == TICK_PAUSED;
+}
+
+void tick_get_stats(tick_stats_t *out) {
+  uint32_t irq = save_and_disable_interrupts();
+  *out = tick_stats;
+  restore_interrupts(irq);
+}
+
+void tick_reset_stats(void) {
+  uint32_t irq = save_and_disable_interrupts();
+  tick_stats = (tick_stats_t) { 0 };
+  restore_interrupts(irq);
+}
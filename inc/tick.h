@@ -0,0 +1,35 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include "pico/stdlib.h"
+
+// Base de tempo do temporizador sobre um alarme de hardware dedicado.
+//
+// Cada tick tem um prazo absoluto, início + n * período em time_us_64(), descontado o tempo em pausa.
+// O alarme é armado no prazo do próximo tick, não a partir do instante em que o anterior foi atendido,
+// então a latência de uma interrupção não se acumula nos ticks seguintes. Se um prazo já passou quando
+// o alarme seria armado, o tick é entregue na hora: nenhum se perde e a contagem volta a acompanhar o relógio.
+
+// Roda na interrupção do alarme. Retorna false para parar depois deste tick.
+typedef bool (*tick_callback_t)(uint32_t tick, void *user_data);
+
+typedef struct {
+  uint32_t ticks;           // Ticks entregues desde o último reset
+  uint32_t late_max_us;     // Maior atraso entre o prazo e a entrega
+  uint64_t late_sum_us;
+  uint32_t catch_up;        // Ticks entregues fora do alarme porque o prazo já havia passado
+  uint32_t pauses;
+  uint64_t paused_us;       // Tempo total em pausa, já devolvido aos prazos
+} tick_stats_t;
+
+void tick_init(void);
+void tick_start(uint32_t period_us, tick_callback_t callback, void *user_data);
+void tick_stop(void);
+void tick_pause(void);
+void tick_resume(void);
+bool tick_running(void);
+bool tick_paused(void);
+void tick_get_stats(tick_stats_t *out);
+void tick_reset_stats(void);
+
+#endif
@@ -0,0 +1,99 @@
+#include "tone.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "trace.h"
+
+static uint tone_pins[2];
+
+// Fila de notas: tone_play escreve em head, o alarme consome em tail.
+static tone_note_t tone_queue[TONE_QUEUE_SIZE];
+static volatile uint32_t tone_head, tone_tail;
+static volatile bool tone_playing;
+
+// Configura o PWM de um pino para gerar uma onda quadrada na frequência dada, ou silêncio se for 0.
+static void tone_set_frequency(uint pin, uint16_t frequency) {
+  uint slice = pwm_gpio_to_slice_num(pin);
+  uint channel = pwm_gpio_to_channel(pin);
+
+  if (!frequency) {
+    pwm_set_chan_level(slice, channel, 0);
+    return;
+  }
+
+  // Menor divisor inteiro que mantém o contador dentro de 16 bits
+  uint32_t clock = clock_get_hz(clk_sys);
+  uint32_t div = clock / (frequency * 65536u) + 1;
+  if (div > 255) div = 255;
+  uint32_t wrap = clock / (div * frequency) - 1;
+  if (wrap > 0xFFFF) wrap = 0xFFFF;
+
+  pwm_set_clkdiv_int_frac(slice, div, 0);
+  pwm_set_wrap(slice, wrap);
+  pwm_set_chan_level(slice, channel, (wrap + 1) / 2);
+}
+
+// Inicia a próxima nota da fila e retorna sua duração em microssegundos, ou 0 se a fila acabou.
+static int64_t tone_advance(void) {
+  if (tone_tail == tone_head) {
+    tone_set_frequency(tone_pins[0], 0);
+    tone_set_frequency(tone_pins[1], 0);
+    tone_playing = false;
+    TRACE_END(TRACE_SOUND);
+    return 0;
+  }
+
+  tone_note_t note = tone_queue[tone_tail & (TONE_QUEUE_SIZE - 1)];
+  tone_tail = tone_tail + 1;
+  TRACE_INSTANT(TRACE_TONE, note.frequency);
+  tone_set_frequency(tone_pins[0], note.frequency);
+  tone_set_frequency(tone_pins[1], note.frequency);
+  return note.duration_ms ? (int64_t) note.duration_ms * 1000 : 1;
+}
+
+// Um valor positivo reagenda o alarme relativo ao instante em que ele deveria ter disparado,
+// então a duração das notas não acumula o atraso da interrupção.
+static int64_t tone_alarm_callback(alarm_id_t id, void *user_data) {
+  return tone_advance();
+}
+
+void tone_init(uint pin_a, uint pin_b) {
+  tone_pins[0] = pin_a;
+  tone_pins[1] = pin_b;
+
+  for (uint i = 0; i < 2; ++i) {
+    gpio_set_function(tone_pins[i], GPIO_FUNC_PWM);
+    uint slice = pwm_gpio_to_slice_num(tone_pins[i]);
+    pwm_set_chan_level(slice, pwm_gpio_to_channel(tone_pins[i]), 0);
+    pwm_set_enabled(slice, true);
+  }
+}
+
+// Enfileira as notas e retorna imediatamente; a reprodução avança pela interrupção do alarme.
+// Retorna false se não houver espaço na fila para a melodia inteira.
+bool tone_play(const tone_note_t *notes, uint count) {
+  uint32_t irq = save_and_disable_interrupts();
+  if (count > TONE_QUEUE_SIZE - (tone_head - tone_tail)) {
+    restore_interrupts(irq);
+    return false;
+  }
+
+  for (uint i = 0; i < count; ++i)
+    tone_queue[(tone_head + i) & (TONE_QUEUE_SIZE - 1)] = notes[i];
+  tone_head = tone_head + count;
+
+  bool start = !tone_playing && count;
+  if (start)
+    tone_playing = true;
+  restore_interrupts(irq);
+
+  if (start) {
+    TRACE_BEGIN_ARG(TRACE_SOUND, count);
+    add_alarm_in_us(tone_advance(), tone_alarm_callback, NULL, true);
+  }
+  return true;
+}
+
+bool tone_busy(void) {
+  return tone_playing;
+}
@@ -0,0 +1,18 @@
+#ifndef TONE_H
+#define TONE_H
+
+#include "pico/stdlib.h"
+
+#define TONE_QUEUE_SIZE 16 // Potência de 2
+
+// Uma nota da melodia. Frequência 0 representa uma pausa.
+typedef struct {
+  uint16_t frequency;
+  uint16_t duration_ms;
+} tone_note_t;
+
+void tone_init(uint pin_a, uint pin_b);
+bool tone_play(const tone_note_t *notes, uint count);
+bool tone_busy(void);
+
+#endif
@@ -0,0 +1,116 @@
+#include <stddef.h>
+#include <string.h>
+#include "trace.h"
+#include "link.h"
+#include "hardware/sync.h"
+
+_Static_assert(!(TRACE_EVENTS & (TRACE_EVENTS - 1)), "TRACE_EVENTS deve ser potência de 2");
+_Static_assert(sizeof(trace_event_t) == 8, "evento de 8 bytes");
+_Static_assert(sizeof(trace_chunk_t) + LINK_OVERHEAD <= LINK_PACKET, "o bloco deve caber num pacote USB");
+
+typedef struct {
+  trace_event_t events[TRACE_EVENTS];
+  volatile uint32_t head;           // Eventos gravados desde o último esvaziamento
+  volatile bool writing;            // O núcleo dono está no meio de uma gravação
+} trace_ring_t;
+
+static trace_ring_t trace_rings[2];
+static volatile bool trace_paused;  // Durante o envio os anéis não mudam
+
+static const struct {
+  const char *name;
+  uint8_t track;
+} trace_ids[TRACE_COUNT] = {
+  [TRACE_EVENTS_BATCH] = { "events", TRACE_TRACK_LOOP },
+  [TRACE_RENDER] = { "render", TRACE_TRACK_LOOP },
+  [TRACE_FLUSH] = { "flush", TRACE_TRACK_LOOP },
+  [TRACE_CHECKPOINT] = { "checkpoint", TRACE_TRACK_LOOP },
+  [TRACE_FLASH] = { "history_flash", TRACE_TRACK_LOOP },
+  [TRACE_SLEEP] = { "sleep", TRACE_TRACK_LOOP },
+  [TRACE_PHASE_END] = { "phase_end", TRACE_TRACK_LOOP },
+  [TRACE_IRQ_GPIO] = { "gpio_irq", TRACE_TRACK_IRQ },
+  [TRACE_IRQ_ADC] = { "adc_irq", TRACE_TRACK_IRQ },
+  [TRACE_IRQ_DMA] = { "dma_irq", TRACE_TRACK_IRQ },
+  [TRACE_TICK] = { "tick", TRACE_TRACK_IRQ },
+  [TRACE_BUTTON] = { "button", TRACE_TRACK_IRQ },
+  [TRACE_TONE] = { "note", TRACE_TRACK_IRQ },
+  [TRACE_I2C] = { "i2c", TRACE_TRACK_I2C },
+  [TRACE_SOUND] = { "sound", TRACE_TRACK_SOUND },
+};
+
+// O instante é lido com as interrupções mascaradas, então a ordem no anel é a ordem dos instantes. A pausa
+// é conferida depois de marcar a gravação em curso: ou trace_dump vê a marca e espera, ou a gravação vê a
+// pausa e desiste (as barreiras mantêm a ordem entre os núcleos).
+void trace_record(uint8_t id, char ph, uint16_t arg) {
+  if (trace_paused)
+    return;
+  trace_ring_t *ring = &trace_rings[get_core_num()];
+  uint32_t irq = save_and_disable_interrupts();
+  ring->writing = true;
+  __dmb();
+  if (!trace_paused) {
+    trace_event_t *e = &ring->events[ring->head++ & (TRACE_EVENTS - 1)];
+    e->ts_us = time_us_32();
+    e->id = id;
+    e->ph = ph;
+    e->arg = arg;
+  }
+  __dmb();
+  ring->writing = false;
+  restore_interrupts(irq);
+}
+
+// Pausa a gravação nos dois núcleos e espera a gravação que o outro núcleo já tenha começado.
+static void trace_pause(void) {
+  trace_paused = true;
+  __dmb();
+  for (uint i = 0; i < count_of(trace_rings); ++i)
+    while (trace_rings[i].writing)
+      tight_loop_contents();
+}
+
+void trace_clear(void) {
+  for (uint i = 0; i < count_of(trace_rings); ++i)
+    trace_rings[i].head = 0;
+}
+
+// Envia os nomes dos eventos e o conteúdo dos dois anéis e os esvazia. Sem terminal conectado, nada é
+// enviado e os anéis continuam como estão. Retorna os eventos enviados.
+uint trace_dump(void) {
+  if (!link_connected())
+    return 0;
+  trace_pause();
+
+  for (uint id = 0; id < TRACE_COUNT; ++id) {
+    uint8_t payload[2 + 32];
+    uint8_t len = strlen(trace_ids[id].name);
+    payload[0] = id;
+    payload[1] = trace_ids[id].track;
+    memcpy(&payload[2], trace_ids[id].name, len);
+    link_send(LINK_TRACE_NAME, payload, 2 + len);
+  }
+
+  uint sent = 0;
+  uint16_t chunk_seq = 0;
+  for (uint core = 0; core < count_of(trace_rings); ++core) {
+    const trace_ring_t *ring = &trace_rings[core];
+    uint32_t head = ring->head;
+    uint32_t count = head < TRACE_EVENTS ? head : TRACE_EVENTS;
+    trace_chunk_t chunk = { .lost = head - count, .core = core };
+
+    for (uint32_t i = head - count; i < head; i += chunk.count) {
+      chunk.count = head - i < TRACE_CHUNK_EVENTS ? head - i : TRACE_CHUNK_EVENTS;
+      chunk.chunk = chunk_seq++;
+      for (uint j = 0; j < chunk.count; ++j)
+        chunk.events[j] = ring->events[(i + j) & (TRACE_EVENTS - 1)];
+      link_send(LINK_TRACE, &chunk, offsetof(trace_chunk_t, events) + chunk.count * sizeof(trace_event_t));
+      chunk.lost = 0;
+      sent += chunk.count;
+    }
+  }
+
+  trace_clear();
+  __dmb();
+  trace_paused = false;
+  return sent;
+}
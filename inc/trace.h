@@ -0,0 +1,104 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "pico/stdlib.h"
+
+// Registro de eventos com instante, para ver a ordem e a sobreposição de interrupções, callbacks de
+// alarme, etapas do laço e transferências I2C.
+//
+// Cada núcleo tem um anel de TRACE_EVENTS eventos de 8 bytes; cheio, o mais antigo é sobrescrito. Um
+// evento é gravado com as interrupções do núcleo mascaradas só durante a reserva da posição e as duas
+// escritas, sem trava entre núcleos: cada núcleo escreve apenas no seu anel. O custo é uma leitura do
+// timer, o número do núcleo e algumas instruções.
+//
+//   TRACE_BEGIN(TRACE_RENDER);
+//   render_ui(&ssd, &ui);
+//   TRACE_END(TRACE_RENDER);
+//
+// O comando 't' pelo stdio (ação T no roteiro do simulador) envia os anéis como quadros binários pela
+// USB (inc/link.h) e os esvazia; tools/tracedump.py converte o fluxo em JSON de trace do Chrome, aberto
+// no Perfetto. Com POMODORO_TRACE desligado as macros somem do código.
+
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS 512            // Por núcleo; potência de 2
+#endif
+
+// Cada evento pertence a uma faixa da linha do tempo do seu núcleo
+typedef enum {
+  TRACE_TRACK_LOOP,                 // Laço principal (núcleo 0) ou do display (núcleo 1)
+  TRACE_TRACK_IRQ,                  // Interrupções e callbacks de alarme
+  TRACE_TRACK_I2C,                  // Transferências por DMA, do início à interrupção de fim
+  TRACE_TRACK_SOUND,                // Melodia, do enfileiramento à última nota
+} trace_track_t;
+
+typedef enum {
+  TRACE_EVENTS_BATCH,               // dispatch_events
+  TRACE_RENDER,
+  TRACE_FLUSH,
+  TRACE_CHECKPOINT,
+  TRACE_FLASH,                      // Gravação de uma página do histórico
+  TRACE_SLEEP,                      // __wfi em wait_for_event
+  TRACE_PHASE_END,                  // arg: fase que terminou
+  TRACE_IRQ_GPIO,
+  TRACE_IRQ_ADC,
+  TRACE_IRQ_DMA,
+  TRACE_TICK,                       // Alarme do tick de um segundo
+  TRACE_BUTTON,                     // Fim do debounce; arg: 1 apertado, 0 solto
+  TRACE_TONE,                       // Próxima nota; arg: frequência
+  TRACE_I2C,                        // arg: bytes no barramento
+  TRACE_SOUND,                      // arg: notas enfileiradas
+  TRACE_COUNT
+} trace_id_t;
+
+#define TRACE_PH_BEGIN 'B'
+#define TRACE_PH_END 'E'
+#define TRACE_PH_INSTANT 'i'
+
+typedef struct {
+  uint32_t ts_us;                   // time_us_32
+  uint8_t id;                       // trace_id_t
+  char ph;                          // TRACE_PH_*
+  uint16_t arg;
+} trace_event_t;
+
+// Carga de um quadro LINK_TRACE: eventos consecutivos de um núcleo, do mais antigo ao mais novo. Seis
+// eventos dão um quadro de 60 bytes, num único pacote USB como os demais.
+#define TRACE_CHUNK_EVENTS 6
+
+typedef struct {
+  uint32_t lost;                    // Eventos sobrescritos antes do envio (só no primeiro bloco do núcleo)
+  uint8_t core;
+  uint8_t count;
+  uint16_t chunk;                   // Número do bloco no envio
+  trace_event_t events[TRACE_CHUNK_EVENTS];
+} trace_chunk_t;
+
+// As funções existem sempre, para o benchmark; sem POMODORO_TRACE nada as chama e o ligador as descarta.
+void trace_record(uint8_t id, char ph, uint16_t arg);
+uint trace_dump(void);
+void trace_clear(void);
+
+#if POMODORO_TRACE
+
+#define TRACE_BEGIN(id) trace_record(id, TRACE_PH_BEGIN, 0)
+#define TRACE_BEGIN_ARG(id, arg) trace_record(id, TRACE_PH_BEGIN, arg)
+#define TRACE_END(id) trace_record(id, TRACE_PH_END, 0)
+#define TRACE_INSTANT(id, arg) trace_record(id, TRACE_PH_INSTANT, arg)
+
+static inline void trace_command(int c) {
+  if (c == 't')
+    trace_dump();
+}
+
+#else
+
+#define TRACE_BEGIN(id) do {} while (0)
+#define TRACE_BEGIN_ARG(id, arg) do {} while (0)
+#define TRACE_END(id) do {} while (0)
+#define TRACE_INSTANT(id, arg) do {} while (0)
+
+static inline void trace_command(int c) { (void) c; }
+
+#endif
+
+#endif
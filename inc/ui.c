@@ -0,0 +1,160 @@
+#include "ui.h"
+#include "widget.h"
+
+// Telas do programa, separadas do laço principal para que o benchmark desenhe exatamente as mesmas cenas.
+// Cada tela é um conjunto de widgets retidos (inc/widget.c): trocar de tela apaga o buffer e invalida os
+// widgets da nova; dentro da mesma tela, só o que mudou é redesenhado.
+
+#define UI_NO_SCREEN 0xFF
+
+static uint8_t ui_drawn_screen = UI_NO_SCREEN;
+
+enum { MENU_FRAME, MENU_TITLE, MENU_VALUE, MENU_WIDGETS };
+static widget_t menu_widgets[MENU_WIDGETS] = {
+  [MENU_FRAME] = WIDGET_FRAME_AT(3, 3, 124, 60),
+  [MENU_TITLE] = WIDGET_LABEL_AT(40, 10, 6, WIDGET_ALIGN_CENTER),
+  [MENU_VALUE] = WIDGET_FONT_NUMBER_AT(24, 24, 80, 32, &font_digits, WIDGET_ALIGN_CENTER),
+};
+
+// Contagem da fase atual em dígitos grandes, com o nome e a duração da fase ao lado e a barra embaixo
+enum { TIMER_FRAME, TIMER_STATUS, TIMER_CLOCK, TIMER_PHASE, TIMER_TOTAL, TIMER_PROGRESS, TIMER_WIDGETS };
+static widget_t timer_widgets[TIMER_WIDGETS] = {
+  [TIMER_FRAME] = WIDGET_FRAME_AT(3, 3, 124, 60),
+  [TIMER_STATUS] = WIDGET_LABEL_AT(6, 6, 15, WIDGET_ALIGN_LEFT),
+  [TIMER_CLOCK] = WIDGET_FONT_LABEL_AT(6, 16, 76, 32, &font_digits, WIDGET_ALIGN_LEFT),
+  [TIMER_PHASE] = WIDGET_LABEL_AT(84, 20, 5, WIDGET_ALIGN_LEFT),
+  [TIMER_TOTAL] = WIDGET_LABEL_AT(84, 34, 5, WIDGET_ALIGN_LEFT),
+  [TIMER_PROGRESS] = WIDGET_BAR_AT(6, 52, 118, 7),
+};
+
+enum { NEW_FRAME, NEW_TITLE, NEW_ACTIVE, NEW_WIDGETS };
+static widget_t new_session_widgets[NEW_WIDGETS] = {
+  [NEW_FRAME] = WIDGET_FRAME_AT(3, 3, 124, 60),
+  [NEW_TITLE] = WIDGET_LABEL_AT(20, 20, 11, WIDGET_ALIGN_LEFT),
+  [NEW_ACTIVE] = WIDGET_LABEL_AT(32, 40, 9, WIDGET_ALIGN_LEFT),
+};
+
+enum { RESUME_FRAME, RESUME_TITLE, RESUME_COUNT, RESUME_AUTO, RESUME_WIDGETS };
+static widget_t resume_widgets[RESUME_WIDGETS] = {
+  [RESUME_FRAME] = WIDGET_FRAME_AT(3, 3, 124, 60),
+  [RESUME_TITLE] = WIDGET_LABEL_AT(36, 10, 7, WIDGET_ALIGN_LEFT),
+  [RESUME_COUNT] = WIDGET_LABEL_AT(24, 28, 10, WIDGET_ALIGN_LEFT),
+  [RESUME_AUTO] = WIDGET_LABEL_AT(20, 46, 11, WIDGET_ALIGN_LEFT),
+};
+
+// Na troca de tela o buffer é apagado e os widgets da nova tela são desenhados inteiros.
+static void ui_begin(ssd1306_t *ssd, uint8_t screen, widget_t *widgets, uint count) {
+  if (ui_drawn_screen == screen)
+    return;
+  ssd1306_fill(ssd, false);
+  widget_invalidate(widgets, count);
+  ui_drawn_screen = screen;
+}
+
+// O buffer foi alterado fora das telas: o próximo quadro é desenhado inteiro.
+void ui_invalidate(void) {
+  ui_drawn_screen = UI_NO_SCREEN;
+}
+
+// Copia a string sem o terminador e retorna o fim.
+static char *ui_append(char *out, const char *text) {
+  while (*text)
+    *out++ = *text++;
+  return out;
+}
+
+// Desenha a tela de seleção de uma configuração.
+void render_menu(ssd1306_t *ssd, const ui_state_t *ui) {
+  static const char *const titles[] = { "Ciclos", "Tempo", "Pausa" };
+
+  if (ui->step >= count_of(titles))
+    return;
+
+  ui_begin(ssd, UI_MENU, menu_widgets, MENU_WIDGETS);
+  widget_frame(ssd, &menu_widgets[MENU_FRAME]);
+  widget_label(ssd, &menu_widgets[MENU_TITLE], titles[ui->step]);
+  widget_number(ssd, &menu_widgets[MENU_VALUE], ui->value);
+}
+
+// Desenha a tela do temporizador em atividade.
+void render_timer(ssd1306_t *ssd, const ui_state_t *ui) {
+  char status[WIDGET_TEXT_MAX];
+  char *end = status;
+
+  // Com mais de uma sessão, a primeira linha também mostra a página
+  if (ui->page_count > 1) {
+    end = widget_utoa(end, ui->page + 1, 1, ' ');
+    *end++ = '/';
+    end = widget_utoa(end, ui->page_count, 1, ' ');
+    end = ui_append(end, ui->paused ? " Pausado" : " Restam ");
+    if (!ui->paused)
+      end = widget_utoa(end, ui->cycles_remaining, 1, ' ');
+  } else if (ui->paused) {
+    end = ui_append(end, "    Pausado");
+  } else {
+    end = ui_append(end, "Restam ");
+    end = widget_utoa(end, ui->cycles_remaining, 1, ' ');
+    end = ui_append(end, " ciclos");
+  }
+  *end = '\0';
+
+  // A contagem e a barra acompanham a fase em curso: o intervalo, se já começou; senão, o trabalho.
+  // work_seconds sobe durante o trabalho e break_seconds desce no intervalo; aqui os dois viram o que resta.
+  bool on_break = ui->break_seconds > 0;
+  uint8_t minutes = on_break ? ui->break_total : ui->work_total;
+  uint32_t length = minutes * 60u;
+  uint32_t left = on_break ? ui->break_seconds : length > ui->work_seconds ? length - ui->work_seconds : 0;
+
+  char clock[WIDGET_TEXT_MAX];
+  end = widget_utoa(clock, left / 60, 2, '0');
+  *end++ = ':';
+  end = widget_utoa(end, left % 60, 2, '0');
+  *end = '\0';
+
+  char total[WIDGET_TEXT_MAX];
+  end = widget_utoa(total, minutes, 1, ' ');
+  end = ui_append(end, "min");
+  *end = '\0';
+
+  widget_t *w = timer_widgets;
+  ui_begin(ssd, UI_TIMER, w, TIMER_WIDGETS);
+  widget_frame(ssd, &w[TIMER_FRAME]);
+  widget_label(ssd, &w[TIMER_STATUS], status);
+  widget_label(ssd, &w[TIMER_CLOCK], clock);
+  widget_label(ssd, &w[TIMER_PHASE], on_break ? "Pausa" : "Tempo");
+  widget_label(ssd, &w[TIMER_TOTAL], total);
+  widget_bar(ssd, &w[TIMER_PROGRESS], length > left ? length - left : 0, length);
+}
+
+// Última página do temporizador: o botão abre o menu para configurar mais uma sessão.
+void render_new_session(ssd1306_t *ssd, const ui_state_t *ui) {
+  char active[WIDGET_TEXT_MAX];
+  char *end = widget_utoa(active, ui->page_count, 1, ' ');
+  end = ui_append(end, " ativas");
+  *end = '\0';
+
+  ui_begin(ssd, UI_NEW_SESSION, new_session_widgets, NEW_WIDGETS);
+  widget_frame(ssd, &new_session_widgets[NEW_FRAME]);
+  widget_label(ssd, &new_session_widgets[NEW_TITLE], "Nova sessao");
+  widget_label(ssd, &new_session_widgets[NEW_ACTIVE], active);
+}
+
+// Primeira tela depois de um reset com sessões salvas: o botão retoma, o joystick descarta.
+void render_resume(ssd1306_t *ssd, const ui_state_t *ui) {
+  char count[WIDGET_TEXT_MAX];
+  char countdown[WIDGET_TEXT_MAX];
+
+  char *end = widget_utoa(count, ui->page_count, 2, ' ');
+  end = ui_append(end, ui->page_count == 1 ? " sessao" : " sessoes");
+  *end = '\0';
+  end = ui_append(countdown, "Auto em ");
+  end = widget_utoa(end, ui->value, 2, ' ');
+  end = ui_append(end, "s");
+  *end = '\0';
+
+  ui_begin(ssd, UI_RESUME, resume_widgets, RESUME_WIDGETS);
+  widget_frame(ssd, &resume_widgets[RESUME_FRAME]);
+  widget_label(ssd, &resume_widgets[RESUME_TITLE], "Retomar");
+  widget_label(ssd, &resume_widgets[RESUME_COUNT], count);
+  widget_label(ssd, &resume_widgets[RESUME_AUTO], countdown);
+}
@@ -0,0 +1,29 @@
+#ifndef UI_H
+#define UI_H
+
+#include "ssd1306.h"
+
+// Estado exibido no display: tudo o que as rotinas de desenho precisam, sem ler as variáveis do temporizador.
+// No modo de dois núcleos é a mensagem enviada do núcleo 0 para o núcleo 1.
+typedef struct {
+  uint8_t screen;             // UI_MENU ou UI_TIMER
+  uint8_t step;               // Configuração em seleção no menu (0 a 2)
+  uint8_t value;              // Valor da opção atual no menu; na retomada, segundos até retomar sozinho
+  uint8_t page, page_count;   // Página exibida e número de sessões em andamento
+  uint8_t cycles_remaining;
+  bool paused;
+  uint16_t work_seconds, break_seconds;   // Contagens da fase, em segundos
+  uint8_t work_total, break_total;        // Durações configuradas, em minutos
+  uint8_t panel;                          // Nível do painel (power_level_t), aplicado por quem desenha
+  uint8_t phase_ends;                     // Fins de fase de qualquer sessão, contador que só avança
+} ui_state_t;
+
+enum { UI_MENU, UI_TIMER, UI_NEW_SESSION, UI_RESUME };
+
+void ui_invalidate(void);
+void render_timer(ssd1306_t *ssd, const ui_state_t *ui);
+void render_menu(ssd1306_t *ssd, const ui_state_t *ui);
+void render_new_session(ssd1306_t *ssd, const ui_state_t *ui);
+void render_resume(ssd1306_t *ssd, const ui_state_t *ui);
+
+#endif
@@ -0,0 +1,90 @@
+#include "wheel.h"
+
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+
+void wheel_init(wheel_t *wheel, uint32_t now) {
+  *wheel = (wheel_t) { .now = now };
+}
+
+static void wheel_link(wheel_timer_t **slot, wheel_timer_t *timer) {
+  timer->next = *slot;
+  if (*slot)
+    (*slot)->pprev = &timer->next;
+  timer->pprev = slot;
+  *slot = timer;
+}
+
+static void wheel_unlink(wheel_timer_t *timer) {
+  *timer->pprev = timer->next;
+  if (timer->next)
+    timer->next->pprev = timer->pprev;
+  timer->next = NULL;
+  timer->pprev = NULL;
+}
+
+// Escolhe o nível pela distância até o prazo e a posição pelos bits do próprio prazo.
+// Distância 0 só ocorre ao descer de nível, e cai na posição do tick em processamento.
+static wheel_timer_t **wheel_slot(wheel_t *wheel, uint32_t expires) {
+  uint32_t delta = expires - wheel->now;
+  if (delta < WHEEL_SLOTS)
+    return &wheel->slots[0][expires & WHEEL_MASK];
+  if (delta < WHEEL_SLOTS * WHEEL_SLOTS)
+    return &wheel->slots[1][(expires >> WHEEL_BITS) & WHEEL_MASK];
+
+  // Além do alcance do último nível, o temporizador espera na posição mais distante e é reinserido ao descer
+  if (delta >= WHEEL_SLOTS * WHEEL_SLOTS * WHEEL_SLOTS)
+    expires = wheel->now + WHEEL_SLOTS * WHEEL_SLOTS * WHEEL_SLOTS - 1;
+  return &wheel->slots[2][(expires >> (2 * WHEEL_BITS)) & WHEEL_MASK];
+}
+
+// Prazos que já venceram, ou vencem no tick atual, disparam no próximo tick.
+void wheel_add(wheel_t *wheel, wheel_timer_t *timer, uint32_t expires) {
+  if (timer->pprev)
+    wheel_cancel(wheel, timer);
+  if ((int32_t) (expires - wheel->now) <= 0)
+    expires = wheel->now + 1;
+  timer->expires = expires;
+  wheel_link(wheel_slot(wheel, expires), timer);
+  wheel->count++;
+}
+
+void wheel_cancel(wheel_t *wheel, wheel_timer_t *timer) {
+  if (!timer->pprev)
+    return;
+  wheel_unlink(timer);
+  wheel->count--;
+}
+
+// Redistribui uma posição de um nível superior pelos níveis abaixo.
+static void wheel_cascade(wheel_t *wheel, uint level, uint index) {
+  wheel_timer_t *timer = wheel->slots[level][index];
+  wheel->slots[level][index] = NULL;
+  while (timer) {
+    wheel_timer_t *next = timer->next;
+    wheel_link(wheel_slot(wheel, timer->expires), timer);
+    timer = next;
+  }
+}
+
+// Avança tick a tick até `now`, chamando os temporizadores que vencem. Um callback pode
+// reinserir o próprio temporizador ou outros.
+void wheel_advance(wheel_t *wheel, uint32_t now) {
+  while ((int32_t) (now - wheel->now) > 0) {
+    uint32_t tick = ++wheel->now;
+    uint index = tick & WHEEL_MASK;
+
+    if (!index) {
+      uint index1 = (tick >> WHEEL_BITS) & WHEEL_MASK;
+      if (!index1)
+        wheel_cascade(wheel, 2, (tick >> (2 * WHEEL_BITS)) & WHEEL_MASK);
+      wheel_cascade(wheel, 1, index1);
+    }
+
+    wheel_timer_t *timer;
+    while ((timer = wheel->slots[0][index])) {
+      wheel_unlink(timer);
+      wheel->count--;
+      timer->callback(timer);
+    }
+  }
+}
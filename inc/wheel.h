@@ -0,0 +1,44 @@
+#ifndef WHEEL_H
+#define WHEEL_H
+
+#include "pico/stdlib.h"
+
+// Roda de temporizadores hierárquica, em ticks.
+//
+// Três níveis de 64 posições: o nível 0 tem uma posição por tick, o nível 1 uma por 64 ticks e o
+// nível 2 uma por 4096 ticks (prazos de até ~72 h com tick de 1 s). Um temporizador entra no nível
+// que cobre a distância até o prazo e desce de nível quando a posição dele é alcançada. Inserir e
+// remover custam O(1); cada avanço de tick só visita a posição atual, então o custo por tick não
+// depende de quantos temporizadores existem (cada um desce no máximo duas vezes).
+
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1u << WHEEL_BITS)
+#define WHEEL_LEVELS 3
+
+struct wheel_timer;
+typedef void (*wheel_callback_t)(struct wheel_timer *timer);
+
+// Embutido na estrutura do dono; o callback recupera o dono pelo endereço.
+typedef struct wheel_timer {
+  struct wheel_timer *next;
+  struct wheel_timer **pprev;   // Ponteiro que aponta para este nó; NULL fora da roda
+  uint32_t expires;
+  wheel_callback_t callback;
+} wheel_timer_t;
+
+typedef struct {
+  wheel_timer_t *slots[WHEEL_LEVELS][WHEEL_SLOTS];
+  uint32_t now;                 // Último tick processado
+  uint32_t count;               // Temporizadores na roda
+} wheel_t;
+
+void wheel_init(wheel_t *wheel, uint32_t now);
+void wheel_add(wheel_t *wheel, wheel_timer_t *timer, uint32_t expires);
+void wheel_cancel(wheel_t *wheel, wheel_timer_t *timer);
+void wheel_advance(wheel_t *wheel, uint32_t now);
+
+static inline bool wheel_pending(const wheel_timer_t *timer) {
+  return timer->pprev != NULL;
+}
+
+#endif
@@ -0,0 +1,161 @@
+#include <string.h>
+#include "widget.h"
+
+void widget_invalidate(widget_t *widgets, uint count) {
+  for (uint i = 0; i < count; ++i)
+    widgets[i].drawn = false;
+}
+
+void widget_frame(ssd1306_t *ssd, widget_t *w) {
+  if (w->drawn)
+    return;
+  ssd1306_rect(ssd, w->y, w->x, w->w, w->h, true, false);
+  w->drawn = true;
+}
+
+// Escreve `value` em decimal a partir de `out`, com pelo menos `width` dígitos completados com `pad`.
+// Retorna o fim do texto, sem terminador.
+char *widget_utoa(char *out, uint value, uint8_t width, char pad) {
+  char digits[10];
+  uint8_t n = 0;
+  do {
+    digits[n++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+
+  while (width > n) {
+    *out++ = pad;
+    width--;
+  }
+  while (n)
+    *out++ = digits[--n];
+  return out;
+}
+
+// Texto com fonte própria: os glifos são opacos na largura de avanço, então basta redesenhar a partir do
+// primeiro que mudou de conteúdo ou de posição e apagar o que sobrou do texto anterior nas pontas.
+static void widget_font_text(ssd1306_t *ssd, widget_t *w, const char *text, uint8_t len) {
+  uint16_t width = 0;
+  uint8_t n = 0;
+  while (n < len) {
+    uint8_t advance = font_glyph(w->font, text[n])->advance;
+    if (width + advance > w->w)
+      break;
+    width += advance;
+    n++;
+  }
+
+  uint8_t lead = 0;
+  if (w->flags & WIDGET_ALIGN_RIGHT)
+    lead = w->w - width;
+  else if (w->flags & WIDGET_ALIGN_CENTER)
+    lead = (w->w - width) / 2;
+
+  // Sem desenho anterior, a caixa inteira conta como ocupada
+  uint8_t old_len = w->drawn ? strlen(w->text) : 0;
+  uint16_t old_start = w->drawn ? w->x + w->offset : w->x;
+  uint16_t old_end = w->drawn ? w->end : w->x + w->w;
+  uint16_t x = w->x + lead;
+  bool moved = !w->drawn || lead != w->offset;
+
+  if (old_start < x)
+    ssd1306_rect(ssd, w->y, old_start, x - old_start, w->h, false, true);
+
+  for (uint8_t i = 0; i < n; ++i) {
+    uint8_t advance = font_glyph(w->font, text[i])->advance;
+    if (moved || i >= old_len || text[i] != w->text[i]) {
+      ssd1306_draw_glyph(ssd, w->font, text[i], x, w->y);
+      if (i >= old_len || advance != font_glyph(w->font, w->text[i])->advance)
+        moved = true;
+      w->text[i] = text[i];
+    }
+    x += advance;
+  }
+  w->text[n] = '\0';
+
+  if (x < old_end)
+    ssd1306_rect(ssd, w->y, x, old_end - x, w->h, false, true);
+
+  w->offset = lead;
+  w->end = x;
+  w->drawn = true;
+}
+
+// Distribui o texto pelas células conforme o alinhamento e desenha só as células que mudaram.
+// Se o deslocamento mudar (centralização com sobra ímpar), a caixa inteira é refeita.
+static void widget_text(ssd1306_t *ssd, widget_t *w, const char *text, uint8_t len) {
+  if (len > w->cells)
+    len = w->cells;
+  if (w->font) {
+    widget_font_text(ssd, w, text, len);
+    return;
+  }
+
+  char cells[WIDGET_TEXT_MAX];
+  uint8_t pad = w->cells - len;
+  uint8_t lead = 0, offset = 0;
+  if (w->flags & WIDGET_ALIGN_RIGHT) {
+    lead = pad;
+  } else if (w->flags & WIDGET_ALIGN_CENTER) {
+    lead = pad / 2;
+    offset = (pad & 1) * 4;
+  }
+  for (uint8_t i = 0; i < w->cells; ++i)
+    cells[i] = i >= lead && i < lead + len ? text[i - lead] : ' ';
+
+  if (w->drawn && offset != w->offset) {
+    ssd1306_rect(ssd, w->y, w->x, w->w, w->h, false, true);
+    w->drawn = false;
+  }
+
+  // Com meio caractere de deslocamento a última célula fica de fora: a sobra é ímpar, então ela é vazia
+  uint8_t count = offset ? w->cells - 1 : w->cells;
+  for (uint8_t i = 0; i < count; ++i) {
+    if (w->drawn && cells[i] == w->text[i])
+      continue;
+    ssd1306_draw_char(ssd, cells[i], w->x + offset + 8 * i, w->y);
+    w->text[i] = cells[i];
+  }
+  w->offset = offset;
+  w->drawn = true;
+}
+
+void widget_label(ssd1306_t *ssd, widget_t *w, const char *text) {
+  uint8_t len = 0;
+  while (text[len] && len < w->cells)
+    len++;
+  widget_text(ssd, w, text, len);
+}
+
+void widget_number(ssd1306_t *ssd, widget_t *w, uint16_t value) {
+  if (w->drawn && value == w->value)
+    return;
+
+  char text[WIDGET_TEXT_MAX];
+  uint8_t width = w->flags & WIDGET_ZERO_PAD ? w->cells : 1;
+  uint8_t len = widget_utoa(text, value, width, '0') - text;
+  widget_text(ssd, w, text, len);
+  w->value = value;
+}
+
+// Contorno na caixa e preenchimento proporcional a value/max por dentro, com 1 pixel de folga.
+// Uma mudança só toca as colunas entre o preenchimento antigo e o novo.
+void widget_bar(ssd1306_t *ssd, widget_t *w, uint32_t value, uint32_t max) {
+  uint8_t inner = w->w - 4;
+  uint16_t filled = max ? (uint16_t) ((uint64_t) (value < max ? value : max) * inner / max) : 0;
+  if (w->drawn && filled == w->value)
+    return;
+
+  uint8_t left = w->x + 2, top = w->y + 2, height = w->h - 4;
+  if (!w->drawn) {
+    ssd1306_rect(ssd, w->y, w->x, w->w, w->h, false, true);
+    ssd1306_rect(ssd, w->y, w->x, w->w, w->h, true, false);
+    ssd1306_rect(ssd, top, left, filled, height, true, true);
+  } else if (filled > w->value) {
+    ssd1306_rect(ssd, top, left + w->value, filled - w->value, height, true, true);
+  } else {
+    ssd1306_rect(ssd, top, left + filled, w->value - filled, height, false, true);
+  }
+  w->value = filled;
+  w->drawn = true;
+}
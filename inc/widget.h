@@ -0,0 +1,69 @@
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include "pico/stdlib.h"
+#include "ssd1306.h"
+
+// Widgets retidos: cada um guarda o que desenhou por último e, quando recebe um valor, só redesenha
+// o que mudou dentro da própria caixa. Textos e números são grades de células de 8x8 comparadas
+// célula a célula; a barra de progresso apaga ou preenche só as colunas de diferença. O trabalho por
+// quadro acompanha o que mudou, não o tamanho da tela.
+//
+// Com `font`, rótulos e números usam essa fonte, com a largura própria de cada glifo, em vez da grade de
+// células; o texto é refeito a partir do primeiro caractere que mudou de conteúdo ou de posição.
+//
+// Quem apaga o buffer por fora (troca de tela, benchmark) deve chamar widget_invalidate, para que o
+// próximo valor seja desenhado inteiro.
+
+#define WIDGET_TEXT_MAX 16
+
+typedef enum {
+  WIDGET_FRAME,     // Retângulo vazado, desenhado uma vez
+  WIDGET_LABEL,     // Texto de até `cells` caracteres
+  WIDGET_NUMBER,    // Inteiro sem sinal, convertido sem sprintf
+  WIDGET_BAR,       // Barra de progresso com contorno
+} widget_kind_t;
+
+enum {
+  WIDGET_ALIGN_LEFT = 0,
+  WIDGET_ALIGN_RIGHT = 1 << 0,
+  WIDGET_ALIGN_CENTER = 1 << 1,   // Sobra ímpar de células vira meio caractere (4 px) de deslocamento
+  WIDGET_ZERO_PAD = 1 << 2,       // Números ocupam todas as células, com zeros à esquerda
+};
+
+typedef struct {
+  uint8_t kind;               // widget_kind_t
+  uint8_t x, y, w, h;         // Caixa; texto em células: w = 8 * cells, h = 8
+  uint8_t cells;              // Caracteres do texto
+  uint8_t flags;
+  bool drawn;                 // O cache corresponde ao que está no buffer
+  uint8_t offset;             // Texto: deslocamento desenhado, em pixels
+  uint16_t value;             // Número: último valor; barra: colunas preenchidas
+  uint8_t end;                // Texto com fonte: coluna seguinte ao último glifo desenhado
+  char text[WIDGET_TEXT_MAX]; // Texto: caracteres desenhados em cada célula ou posição
+  const font_t *font;         // Fonte do texto; NULL usa as células de 8x8
+} widget_t;
+
+#define WIDGET_FRAME_AT(x_, y_, w_, h_) { .kind = WIDGET_FRAME, .x = (x_), .y = (y_), .w = (w_), .h = (h_) }
+#define WIDGET_LABEL_AT(x_, y_, cells_, flags_) \
+  { .kind = WIDGET_LABEL, .x = (x_), .y = (y_), .w = 8 * (cells_), .h = 8, .cells = (cells_), .flags = (flags_) }
+#define WIDGET_NUMBER_AT(x_, y_, cells_, flags_) \
+  { .kind = WIDGET_NUMBER, .x = (x_), .y = (y_), .w = 8 * (cells_), .h = 8, .cells = (cells_), .flags = (flags_) }
+#define WIDGET_FONT_TEXT_AT(kind_, x_, y_, w_, h_, font_, flags_) \
+  { .kind = (kind_), .x = (x_), .y = (y_), .w = (w_), .h = (h_), .cells = WIDGET_TEXT_MAX - 1, .flags = (flags_), \
+    .font = (font_) }
+#define WIDGET_FONT_LABEL_AT(x_, y_, w_, h_, font_, flags_) \
+  WIDGET_FONT_TEXT_AT(WIDGET_LABEL, x_, y_, w_, h_, font_, flags_)
+#define WIDGET_FONT_NUMBER_AT(x_, y_, w_, h_, font_, flags_) \
+  WIDGET_FONT_TEXT_AT(WIDGET_NUMBER, x_, y_, w_, h_, font_, flags_)
+#define WIDGET_BAR_AT(x_, y_, w_, h_) { .kind = WIDGET_BAR, .x = (x_), .y = (y_), .w = (w_), .h = (h_) }
+
+void widget_invalidate(widget_t *widgets, uint count);
+void widget_frame(ssd1306_t *ssd, widget_t *w);
+void widget_label(ssd1306_t *ssd, widget_t *w, const char *text);
+void widget_number(ssd1306_t *ssd, widget_t *w, uint16_t value);
+void widget_bar(ssd1306_t *ssd, widget_t *w, uint32_t value, uint32_t max);
+
+char *widget_utoa(char *out, uint value, uint8_t width, char pad);
+
+#endif
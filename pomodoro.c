@@ -2,106 +2,170 @@
 #include "pico/stdlib.h"
 #include "hardware/timer.h"
 #include "hardware/i2c.h"
-#include "hardware/adc.h"
+#include "hardware/sync.h"
 #include "inc/ssd1306.h"
+#include "inc/tone.h"
+#include "inc/ui.h"
+#include "inc/profile.h"
+#include "inc/input.h"
+#include "inc/event.h"
+#include "inc/tick.h"
+#include "inc/session.h"
+#include "inc/history.h"
+#include "inc/checkpoint.h"
+#include "inc/power.h"
+#include "inc/anim.h"
+#include "inc/stats.h"
+#include "inc/trace.h"
+
+#ifdef POMODORO_DUAL_CORE
+#include "pico/multicore.h"
+#include "pico/flash.h"
+#endif
 
 // Definição de constantes
 #define B_BUTTON 6
-#define JOYSTICK_X 26
+#define JOYSTICK_ADC 1 // Eixo X do joystick no GPIO 27
 #define A_BUZZER 21
 #define B_BUZZER 10
 
-#define I2C_PORT i2c1
+#define I2C_PORT SSD1306_I2C
 #define I2C_SDA 14
 #define I2C_SCL 15
-#define endereco 0x3C
-#define DISPLAY_WIDTH 128
-#define DISPLAY_HEIGHT 64
+#define endereco SSD1306_ADDRESS
 #define RECT_SIZE 8
 
-uint32_t last_time;
-
-volatile bool cor = true;
-volatile bool active = false;
-volatile bool sound = false;
+// Estado do programa. Só o laço principal lê e escreve; as interrupções se comunicam pela fila de eventos.
+uint8_t screen = UI_MENU;  // UI_MENU, UI_TIMER ou UI_RESUME
+bool state_changed = true; // Sinaliza que algo exibido no display mudou e a tela deve ser redesenhada
 
 // Predefinições de tempo que poderão ser escolhidas no programa
 static uint8_t cycles[] = { 2, 3, 4, 5 };
 static uint8_t work_time[] = { 20, 25, 30, 40, 50, 60 };
 static uint8_t break_time[] = { 5, 10, 15 };
+_Static_assert(count_of(work_time) == STATS_PRESETS, "uma sequência por opção de tempo de trabalho");
 
 // Variáveis utilizadas para salvar as configurações escolhidas pelo usuário
 uint8_t ind_cycles, ind_work, ind_break;
 uint8_t selected_config;
 uint8_t indice;
 
-// Variáveis para o temporizador
-uint8_t work_minutes, break_minutes, cycles_remaining;
+// Sessões em andamento (inc/session.c), uma página do display por sessão e uma última para criar outra
+uint page;                  // Página exibida; sessions_active() é a página "Nova sessão"
+session_t *shown;           // Sessão da página exibida, NULL na página "Nova sessão"
+
+// Tick de um segundo, sempre ativo: é o relógio da roda de temporizadores das sessões
+#define TICK_PERIOD_US 1000000
+static uint32_t session_clock;  // Último tick entregue à roda
+
+// Checkpoint na flash da última configuração e das sessões em andamento. Depois de um reset com sessões
+// salvas, a tela de retomada espera um toque no botão, ou retoma sozinha após RESUME_TIMEOUT_S.
+#define CHECKPOINT_PERIOD_S 60
+#define RESUME_TIMEOUT_S 10
+static checkpoint_t boot_checkpoint;
+static bool checkpoint_due;
+
+// Fins de fase de qualquer sessão: cada um faz o painel piscar em vídeo inverso (inc/anim.c)
+static uint8_t phase_ends;
+#define PHASE_END_FLASHES 2
+
+// Economia de energia (inc/power.c): contraste reduzido e painel apagado sem entradas, clk_sys reduzido
+// na espera. Com POMODORO_POWER_SAVE=0 o gerenciador só mede, para comparar o consumo estimado.
+#ifndef POMODORO_POWER_SAVE
+#define POMODORO_POWER_SAVE 1
+#endif
+#define DIM_AFTER_S 30
+#define BLANK_AFTER_S 120
+#define IDLE_CLOCK_KHZ 12500
+
+// Fila de eventos das interrupções para o laço principal
+#define EVENT_QUEUE_SIZE 32 // Potência de 2
+#define EVENT_BATCH 8
+static event_t event_buffer[EVENT_QUEUE_SIZE];
+static event_ring_t events;
+
+// Contadores para medir o ciclo de trabalho de cada núcleo
+profile_duty_t duty;
+
+// O display pertence a quem desenha: o laço principal, ou o núcleo 1 no modo de dois núcleos.
+static ssd1306_t ssd;
+static bool flush_pending;
 
 // Protótipo das Funções
 void setup(void);
-static void gpio_irq_handler(uint gpio, uint32_t events);
-void setup_menu(ssd1306_t ssd);
-bool minute_timer_callback(struct repeating_timer *t);
-void nota(uint32_t frequencia, uint32_t tempo_ms);
+bool session_tick_callback(uint32_t tick, void *user_data);
 void timer_sound();
+void boot_restore(void);
+void boot_resume(void);
+void boot_discard(void);
+void checkpoint_write(void);
+void display_init(void);
+void ui_publish(void);
+void ui_present(const ui_state_t *ui);
+bool display_idle(void);
+void display_service(void);
+void render_ui(ssd1306_t *ssd, const ui_state_t *ui);
+void menu_move(int8_t dir);
+void menu_select(void);
+void menu_open(void);
+void page_show(uint index);
+void page_move(int8_t dir);
+void dispatch_events(void);
+void timer_tick(uint16_t tick);
+void timer_phase_end(session_t *session, uint8_t phase);
+bool panel_wake(void);
+void history_log(const session_t *session);
+void wait_for_event(void);
+void console_poll(void);
+#ifdef POMODORO_DUAL_CORE
+static void display_core1_main(void);
+#endif
 
 int main()
 {
     setup(); // Configuração das portas digitais
-
-    // Habilitando interrupção da gpio no botão B.
-    gpio_set_irq_enabled_with_callback(B_BUTTON, GPIO_IRQ_EDGE_FALL, 1, & gpio_irq_handler);
-
-    // Configuração inicial do display ssd1306, iniciado com todos os pixels apagados.
-    ssd1306_t ssd; 
-    ssd1306_init(&ssd, WIDTH, HEIGHT, false, endereco, I2C_PORT);
-    ssd1306_config(&ssd); 
-    ssd1306_send_data(&ssd);
-    ssd1306_fill(&ssd, false);
-    ssd1306_send_data(&ssd);
-
-    // Variáveis para armazenar os textos do display
-    char str_ciclos[20];
-    char str_work[20];
-    char str_break[20];
-    
+    boot_restore();
+
+    duty.start_us = time_us_64();
+    profile_init();
+    profile_watch_events(&events);
+    profile_watch_duty(&duty);
+
+#ifdef POMODORO_DUAL_CORE
+    // O núcleo 1 assume o display e o barramento I2C; este núcleo fica com o temporizador e as entradas.
+    multicore_launch_core1(display_core1_main);
+#else
+    display_init();
+#endif
+
+    // O primeiro quadro sai antes da leitura do histórico, que percorre toda a região dele na flash
+    state_changed = false;
+    ui_publish();
+    history_init();
+    stats_init(history_boot());
+
+    // O laço só acorda quando uma interrupção publica um evento. No menu o usuário escolhe as configurações
+    // de uma nova sessão; na tela do temporizador, o joystick pagina as sessões em andamento.
     while(true) {
-        // Se o temporizador não estiver ativo, o usuário poderá selecionar as configurações de tempo desejadas.
-        if (!active) {
-            selected_config = 0;
-            indice = 0;
-            setup_menu(ssd);
-        }
+        uint64_t wake_us = time_us_64();
 
-        else {
-            struct repeating_timer timer;
-
-            // Configura o temporizador para chamar a função de callback a cada minuto.
-            add_repeating_timer_ms(60000, minute_timer_callback, NULL, &timer);
-
-            // Define a quantidade de ciclos
-            cycles_remaining = cycles[ind_cycles];
-
-            // Temporizador em atividade
-            while (active) {
-                sprintf(str_ciclos, "Restam %d ciclos", cycles_remaining);
-                sprintf(str_work, "  Tempo   %d %d", work_minutes, work_time[ind_work]);
-                sprintf(str_break, "Intervalo %d %d", break_minutes, break_time[ind_break]);
-                ssd1306_fill(&ssd, !cor);
-                ssd1306_rect(&ssd, 3, 3, 124, 60, cor, !cor);
-                ssd1306_draw_string(&ssd, str_ciclos, 6, 10);
-                ssd1306_draw_string(&ssd, str_work, 6, 28);
-                ssd1306_draw_string(&ssd, str_break, 6, 46);
-                ssd1306_send_data(&ssd);
+        dispatch_events();
+        if (state_changed) {
+            state_changed = false;
+            ui_publish();
+        }
+        display_service();
+        console_poll();
+        profile_poll();
+        history_service();
+        stats_service();
+        if (checkpoint_due) {
+            checkpoint_due = false;
+            checkpoint_write();
+        }
 
-                // Se a flag de emitir som for ativa, emite o som e desliga a flag
-                if (sound) {
-                    timer_sound();
-                    sound = false;
-                }
-            }
-        }   
+        duty.busy_us[0] += time_us_64() - wake_us;
+        wait_for_event();
     }
 
     return 0;
@@ -110,20 +174,41 @@ int main()
 // Inicialização e configuração das portas digitais
 void setup(void)
 {
-    stdio_init_all();
-
-    gpio_init(B_BUTTON);        // Inicializando Botão B.
-    gpio_set_dir(B_BUTTON, GPIO_IN);
-    gpio_pull_up(B_BUTTON);
+    // Antes dos periféricos, que calculam os divisores pelo clk_sys normal
+    static const power_config_t power_config = {
+        .dim_after_s = POMODORO_POWER_SAVE ? DIM_AFTER_S : 0,
+        .blank_after_s = POMODORO_POWER_SAVE ? BLANK_AFTER_S : 0,
+        .contrast = 0xFF,
+        .dim_contrast = 0x10,
+        .idle_khz = POMODORO_POWER_SAVE ? IDLE_CLOCK_KHZ : 0,
+    };
+    power_init(&power_config);
 
-    adc_init();                 // Inicializar o ADC
-    adc_gpio_init(JOYSTICK_X);  // Configurar GPIO para eixo X
-
-    gpio_init(A_BUZZER); // Inicializa o pino do buzzer A
-    gpio_set_dir(A_BUZZER, GPIO_OUT);
+    stdio_init_all();
 
-    gpio_init(B_BUZZER); // Inicializa o pino do buzzer B
-    gpio_set_dir(B_BUZZER, GPIO_OUT);
+    // Botão B e eixo X do joystick: amostragem contínua do ADC e debounce feitos por interrupção
+    static const input_config_t input_config = {
+        .adc_input = JOYSTICK_ADC,
+        .button_gpio = B_BUTTON,
+        .sample_rate_hz = 1000,
+        .oversample = 16,           // Uma leitura filtrada a cada 16 ms
+        .left_threshold = 1500,
+        .right_threshold = 2700,
+        .hysteresis = 200,
+        .repeat_delay_ms = 400,
+        .repeat_interval_ms = 150,
+        .debounce_ms = 20,
+    };
+    event_ring_init(&events, event_buffer, EVENT_QUEUE_SIZE);
+    input_init(&input_config, &events);
+    input_set_joystick(true);
+
+    // Todas as sessões compartilham a roda, movida por um único alarme de hardware
+    sessions_init(0, timer_phase_end);
+    tick_init();
+    tick_start(TICK_PERIOD_US, session_tick_callback, NULL);
+
+    tone_init(A_BUZZER, B_BUZZER); // Buzzers A e B acionados por PWM
 
     // Inicialização do I2C em 400Khz.
     i2c_init(I2C_PORT, 400 * 1000);
@@ -134,193 +219,548 @@ void setup(void)
     gpio_pull_up(I2C_SCL);
 }
 
-// Rotina da Interrupção
-static void gpio_irq_handler(uint gpio, uint32_t events){
-
-    uint32_t current_time = to_us_since_boot(get_absolute_time());
-    if (current_time - last_time > 200000) // Delay de 200ms para debounce
-    {
-        last_time = current_time;
-
-        switch (gpio) {
-
-        case B_BUTTON:
-            if (!active) {
-                switch (selected_config) {
-                    case 0: // Salva o índice da quantidade de ciclos selecionada
-                        ind_cycles = indice;
-                        indice = 0;
-                        selected_config += 1;
-                        break;
-                    case 1: // Salva o índice dos minutos de trabalho selecionado
-                        ind_work = indice;
-                        indice = 0;
-                        selected_config += 1;
+// Esvazia a fila de eventos em lotes e trata cada um conforme a tela atual.
+void dispatch_events(void) {
+    event_t batch[EVENT_BATCH];
+    uint count;
+
+    PROFILE_BEGIN(PROFILE_EVENTS);
+    TRACE_BEGIN(TRACE_EVENTS_BATCH);
+    while ((count = event_drain(&events, batch, count_of(batch)))) {
+        for (uint i = 0; i < count; ++i) {
+            const event_t *event = &batch[i];
+            switch (event->type) {
+                case EVENT_TICK:
+                    timer_tick(event->data);
+                    break;
+                case EVENT_JOYSTICK:
+                    // No menu o joystick troca a opção; no temporizador, a página. Na retomada, descarta as sessões salvas.
+                    if (panel_wake())
                         break;
-                    case 2: // Salva o índice da dos minutos de intervalo selecionado
-                        ind_break = indice;
-                        indice = 0;
-                        selected_config += 1;
+                    if (screen == UI_MENU)
+                        menu_move(event->arg);
+                    else if (screen == UI_RESUME)
+                        boot_discard();
+                    else
+                        page_move(event->arg);
+                    break;
+                case EVENT_BUTTON:
+                    // No menu o botão confirma a opção. No temporizador, pausa e retoma a sessão exibida,
+                    // ou abre o menu na página "Nova sessão".
+                    if (!event->arg || panel_wake())
                         break;
-                }
+                    if (screen == UI_MENU) {
+                        menu_select();
+                    } else if (screen == UI_RESUME) {
+                        boot_resume();
+                    } else if (shown) {
+                        session_toggle_pause(shown);
+                        state_changed = true;
+                        checkpoint_due = true;
+                    } else {
+                        menu_open();
+                    }
+                    break;
             }
+        }
+    }
+    TRACE_END(TRACE_EVENTS_BATCH);
+    PROFILE_END(PROFILE_EVENTS);
+}
+
+// Move o índice da opção atual, com retorno circular.
+void menu_move(int8_t dir) {
+    static const uint8_t option_count[] = { count_of(cycles), count_of(work_time), count_of(break_time) };
+    uint8_t count = option_count[selected_config];
+
+    if (dir > 0) {
+        if (indice == count - 1) { indice = 0; }
+        else { indice++; }
+    }
+
+    else {
+        if (indice == 0) { indice = count - 1; }
+        else { indice--; }
+    }
+    state_changed = true;
+}
+
+// Confirma a opção atual e passa para a próxima configuração, já posicionada na escolha anterior.
+// Após a terceira, começa a sessão.
+void menu_select(void) {
+    switch (selected_config) {
+        case 0: // Salva o índice da quantidade de ciclos selecionada
+            ind_cycles = indice;
+            break;
+        case 1: // Salva o índice dos minutos de trabalho selecionado
+            ind_work = indice;
             break;
-        
-        default:
+        case 2: // Salva o índice da dos minutos de intervalo selecionado
+            ind_break = indice;
             break;
+    }
+    selected_config += 1;
+    indice = selected_config == 1 ? ind_work : ind_break;
+    state_changed = true;
+
+    if (selected_config == 3) {
+        session_t *session = session_start(cycles[ind_cycles], work_time[ind_work], break_time[ind_break]);
+        if (session) {
+            session->preset[0] = ind_cycles;
+            session->preset[1] = ind_work;
+            session->preset[2] = ind_break;
         }
+        screen = UI_TIMER;
+        page_show(session ? session_index(session) : 0);
+        checkpoint_due = true;
     }
 }
 
-void setup_menu(ssd1306_t ssd) {
-    char value[3];
-    uint16_t adc_value_x;
+// Começa a escolha das configurações de uma nova sessão, a partir da última configuração usada.
+void menu_open(void) {
+    screen = UI_MENU;
+    selected_config = 0;
+    indice = ind_cycles;
+    state_changed = true;
+}
 
-    while(true)
-    {
-        // Seleção da configuração 1: quantidade de clicos
-        if (!selected_config) {
-            adc_select_input(1);
-            adc_value_x = adc_read();
+void page_show(uint index) {
+    page = index;
+    shown = session_at(index);
+    state_changed = true;
+}
 
-            if (adc_value_x > 2700) {
-                if (indice == 3) { indice = 0; }
-                else { indice++; }
-            }
+// Percorre as sessões e a página "Nova sessão", com retorno circular. Sem vagas, a última página some.
+void page_move(int8_t dir) {
+    uint count = sessions_active();
+    uint pages = count < SESSION_MAX ? count + 1 : count;
+    page_show((page + pages + (dir > 0 ? 1 : -1)) % pages);
+}
 
-            else if (adc_value_x < 1500) {
-                if (indice == 0) { indice = 3; }
-                else { indice--; }
-            }
+// Captura o estado atual do menu ou do temporizador para o display.
+static ui_state_t ui_snapshot(void) {
+    ui_state_t ui = {
+        .screen = screen,
+        .step = selected_config,
+        .page = page,
+        .page_count = sessions_active(),
+        .panel = power_level(),
+        .phase_ends = phase_ends,
+    };
+
+    if (screen == UI_RESUME) {
+        ui.page_count = boot_checkpoint.count;
+        ui.value = RESUME_TIMEOUT_S - session_clock;
+    } else if (screen == UI_TIMER && shown) {
+        ui.cycles_remaining = shown->cycles_remaining;
+        ui.paused = shown->paused;
+        ui.work_seconds = session_work_seconds(shown);
+        ui.work_total = shown->work_minutes;
+        ui.break_seconds = session_break_seconds(shown);
+        ui.break_total = shown->break_minutes;
+    } else if (screen == UI_TIMER) {
+        ui.screen = UI_NEW_SESSION;
+    } else {
+        // O valor da configuração escolhida só aparece no menu; na retomada ele é a contagem regressiva
+        switch (selected_config) {
+            case 0: ui.value = cycles[indice]; break;
+            case 1: ui.value = work_time[indice]; break;
+            case 2: ui.value = break_time[indice]; break;
+        }
+    }
+    return ui;
+}
 
-            sleep_ms(100);
+// Configuração inicial do display ssd1306, iniciado com todos os pixels apagados.
+// Não há limpeza prévia: até o primeiro envio a RAM do display é desconhecida, então o driver manda
+// o primeiro quadro desenhado inteiro, e ele já substitui o conteúdo antigo.
+void display_init(void) {
+    ssd1306_init(&ssd, SSD1306_BACKEND, WIDTH, HEIGHT, false, endereco, I2C_PORT);
+    ssd1306_config(&ssd);
+}
 
-            sprintf(value, "%d", cycles[indice]);
-            ssd1306_fill(&ssd, !cor);
-            ssd1306_rect(&ssd, 3, 3, 124, 60, cor, !cor);
-            ssd1306_draw_string(&ssd, "Ciclos", 40, 10);
-            ssd1306_draw_string(&ssd, value, 60, 30);
-            ssd1306_send_data(&ssd);
-        }
+// Registra uma única vez o tempo do reset até o primeiro quadro completo no display.
+// Com `wait`, espera o fim da transferência em vez de verificar de novo na próxima passagem.
+static void first_frame_check(bool wait) {
+    static bool done;
+    if (done || !ssd.frames)
+        return;
+    if (wait)
+        ssd1306_wait(&ssd);
+    if (!ssd1306_busy(&ssd)) {
+        done = true;
+        profile_record(PROFILE_FIRST_FRAME, time_us_32());
+    }
+}
 
-        // Seleção da configuração 2: Minutos de trabalho
-        if (selected_config == 1) {
-            adc_select_input(1);
-            adc_value_x = adc_read();
+// Animações da troca de estado, decididas por quem desenha a partir do estado recebido: a cada fim de
+// fase o painel pisca, e quando a sessão exibida muda de fase a tela nova entra por uma cortina, página
+// a página, em vez de um envio comum. Retorna true se a cortina assumiu o envio do quadro.
+static bool display_animate(const ui_state_t *ui) {
+    static ui_state_t last = { .screen = UI_MENU };
+    bool on_break = ui->break_seconds > 0;
+    bool same_timer = ui->screen == UI_TIMER && last.screen == UI_TIMER && ui->page == last.page;
+    bool wipe = same_timer && on_break != (last.break_seconds > 0);
+
+    if (ui->phase_ends != last.phase_ends)
+        anim_flash(PHASE_END_FLASHES);
+    last = *ui;
+    return wipe && anim_wipe(&ssd);
+}
 
-            if (adc_value_x > 2700) {
-                if (indice == 5) { indice = 0; }
-                else { indice++; }
-            }
+#ifdef POMODORO_DUAL_CORE
 
-            else if (adc_value_x < 1500) {
-                if (indice == 0) { indice = 5; }
-                else { indice--; }
-            }
+// Caixa de correio com o último estado publicado, protegida por um contador de sequência:
+// ímpar enquanto o núcleo 0 escreve. A FIFO entre os núcleos só serve de campainha,
+// então o núcleo 0 nunca bloqueia se o núcleo 1 estiver ocupado enviando um quadro.
+static ui_state_t ui_mailbox;
+static volatile uint32_t ui_mailbox_seq;
+
+static void ui_mailbox_write(const ui_state_t *ui) {
+    ui_mailbox_seq = ui_mailbox_seq + 1;
+    __dmb();
+    ui_mailbox = *ui;
+    __dmb();
+    ui_mailbox_seq = ui_mailbox_seq + 1;
+}
+
+// Retorna o número de sequência do estado lido
+static uint32_t ui_mailbox_read(ui_state_t *ui) {
+    uint32_t seq;
+    do {
+        while ((seq = ui_mailbox_seq) & 1)
+            tight_loop_contents();
+        __dmb();
+        *ui = ui_mailbox;
+        __dmb();
+    } while (seq != ui_mailbox_seq);
+    return seq;
+}
+
+// Último estado que o núcleo 1 terminou de desenhar e enviar, publicado só com o barramento livre
+static volatile uint32_t ui_drawn_seq;
 
-            sleep_ms(100);
+// A campainha é o próprio número de sequência, com um __sev para tirar o núcleo 1 do __wfe. A FIFO entre os
+// núcleos fica livre para a pausa do núcleo 1 durante as gravações na flash, cuja interrupção descarta
+// qualquer outra palavra que chegue por ela.
+void ui_present(const ui_state_t *ui) {
+    ui_mailbox_write(ui);
+    __sev();
+}
+
+// O núcleo 1 desenha e envia no mesmo clk_sys: o relógio só cai depois que ele alcança o último estado,
+// o quadro sai inteiro pelo I2C e nenhuma cortina ou piscada está em curso (ela só publica sem animação).
+bool display_idle(void) {
+    return ui_drawn_seq == ui_mailbox_seq;
+}
+
+void display_service(void) {
+}
+
+// Quadros e passos de animação são do núcleo 1: este núcleo dorme mesmo com eles pendentes.
+static bool display_pending(void) {
+    return false;
+}
 
-            sprintf(value, "%d", work_time[indice]);
-            ssd1306_fill(&ssd, !cor);
-            ssd1306_rect(&ssd, 3, 3, 124, 60, cor, !cor);
-            ssd1306_draw_string(&ssd, "Tempo", 44, 10);
-            ssd1306_draw_string(&ssd, value, 56, 30);
-            ssd1306_send_data(&ssd); 
+// Laço do núcleo 1: espera o número de sequência mudar e desenha apenas o estado mais recente.
+static void display_core1_main(void) {
+    // Permite ao núcleo 0 pausar este núcleo enquanto grava o histórico na flash
+    flash_safe_execute_core_init();
+    display_init();
+
+    bool flush_deferred = false;
+    uint32_t drawn_seq = 0;
+    while (true) {
+        // Sem animação, o estado desenhado é publicado depois do fim da transferência, antes de dormir. Com
+        // uma animação em curso, o estado novo só é esperado até o prazo do próximo passo: o alarme dela
+        // também dá o __sev.
+        if (!anim_running()) {
+            ssd1306_wait(&ssd);
+            ui_drawn_seq = drawn_seq;
         }
-        
-        // Seleção da configuração 3: Minutos de intervalo
-        if (selected_config == 2) {
-            adc_select_input(1);
-            adc_value_x = adc_read();
-
-            if (adc_value_x > 2700) {
-                if (indice == 2) { indice = 0; }
-                else { indice++; }
+        while (ui_mailbox_seq == drawn_seq && !anim_due())
+            __wfe();
+        if (ui_mailbox_seq == drawn_seq) {
+            uint64_t start_us = time_us_64();
+            anim_service(&ssd);
+            if (flush_deferred && !anim_busy()) {
+                flush_deferred = false;
+                ssd1306_send_data(&ssd);
             }
+            duty.busy_us[1] += time_us_64() - start_us;
+            continue;
+        }
 
-            else if (adc_value_x < 1500) {
-                if (indice == 0) { indice = 2; }
-                else { indice--; }
+        uint64_t start_us = time_us_64();
+        ui_state_t ui;
+        uint32_t seq = ui_mailbox_read(&ui);
+        power_panel(&ssd, ui.panel);
+        if (ui.panel != POWER_BLANK) {
+            render_ui(&ssd, &ui);
+
+            // Durante a cortina o quadro fica no buffer e sai quando ela termina
+            if (display_animate(&ui) || anim_busy()) {
+                flush_deferred = true;
+            } else {
+                PROFILE_BEGIN(PROFILE_FLUSH);
+                TRACE_BEGIN(TRACE_FLUSH);
+                while (!ssd1306_send_data_async(&ssd)) {
+                    PROFILE_BEGIN(PROFILE_FLUSH_WAIT);
+                    ssd1306_wait(&ssd);
+                    PROFILE_END(PROFILE_FLUSH_WAIT);
+                }
+                TRACE_END(TRACE_FLUSH);
+                PROFILE_END(PROFILE_FLUSH);
+                first_frame_check(true);
             }
+        }
+        drawn_seq = seq;
+        duty.busy_us[1] += time_us_64() - start_us;
+    }
+}
 
-            sleep_ms(100);
+#else
+
+// Com o painel apagado o quadro não é desenhado; ao acender, o envio parte da diferença para a sombra.
+void ui_present(const ui_state_t *ui) {
+    power_panel(&ssd, ui->panel);
+    if (ui->panel == POWER_BLANK)
+        return;
+    render_ui(&ssd, ui);
+    display_animate(ui);
+    flush_pending = true;
+    display_service();
+}
 
-            sprintf(value, "%d", break_time[indice]);
-            ssd1306_fill(&ssd, !cor);
-            ssd1306_rect(&ssd, 3, 3, 124, 60, cor, !cor);
-            ssd1306_draw_string(&ssd, "Pausa", 44, 10);
-            ssd1306_draw_string(&ssd, value, 60, 30);
-            ssd1306_send_data(&ssd); 
-        }
+// O I2C é medido pelo clk_sys: o relógio só cai com a transferência terminada e a FIFO vazia, e fora
+// das animações, cujos passos enviam páginas a cada 30 ms.
+bool display_idle(void) {
+    return !ssd1306_busy(&ssd) && !anim_running();
+}
 
-        sleep_ms(200);
+// Transferência por DMA: o próximo quadro é desenhado enquanto o atual é enviado.
+// Se os dois buffers estiverem ocupados, tenta de novo quando o DMA terminar. Durante a cortina o
+// quadro espera, e sai pelo envio comum quando ela termina.
+void display_service(void) {
+    if (anim_due())
+        anim_service(&ssd);
+    if (flush_pending && !anim_busy()) {
+        PROFILE_BEGIN(PROFILE_FLUSH);
+        TRACE_BEGIN(TRACE_FLUSH);
+        flush_pending = !ssd1306_send_data_async(&ssd);
+        TRACE_END(TRACE_FLUSH);
+        PROFILE_END(PROFILE_FLUSH);
+    }
+    first_frame_check(false);
+}
 
-        // Após selecionar as 3 configurações, inicia o temporizador
-        if (selected_config == 3) {
-            active = true;
-            break;
-        }
+// Há um quadro ou passo de animação a enviar assim que o DMA aceitar
+static bool display_pending(void) {
+    return ((flush_pending && !anim_busy()) || anim_due()) && !ssd.dma_pending;
+}
+
+#endif
+
+// Publica o estado atual para quem desenha, no relógio normal. Com o painel já apagado nada visível
+// muda, e o laço nem acorda o outro núcleo nem sobe o relógio.
+void ui_publish(void) {
+    static bool blank_published;
+    bool blank = power_level() == POWER_BLANK;
+    if (blank && blank_published)
+        return;
+    blank_published = blank;
+
+    power_clock_full();
+    ui_state_t ui = ui_snapshot();
+    ui_present(&ui);
+}
+
+void render_ui(ssd1306_t *ssd, const ui_state_t *ui) {
+    PROFILE_BEGIN(PROFILE_RENDER);
+    TRACE_BEGIN(TRACE_RENDER);
+    if (ui->screen == UI_TIMER)
+        render_timer(ssd, ui);
+    else if (ui->screen == UI_NEW_SESSION)
+        render_new_session(ssd, ui);
+    else if (ui->screen == UI_RESUME)
+        render_resume(ssd, ui);
+    else
+        render_menu(ssd, ui);
+    duty.renders++;
+    TRACE_END(TRACE_RENDER);
+    PROFILE_END(PROFILE_RENDER);
+}
+
+// Dorme até a próxima interrupção, a menos que já exista trabalho pendente.
+// As interrupções ficam mascaradas durante a verificação para que um evento sinalizado
+// entre o teste e o __wfi não seja perdido: o __wfi acorda com a interrupção pendente.
+// Um envio adiado só é trabalho pendente se já houver buffer livre; senão a interrupção do DMA acorda o laço.
+// O mesmo vale para um passo de animação vencido; antes do prazo, o alarme da animação acorda o laço.
+// Sem quadro por desenhar ou no barramento nem som tocando (o I2C e o PWM seguem o clk_sys), o relógio é
+// reduzido durante o sono.
+void wait_for_event(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    if (!display_pending() && !state_changed && !profile_pending() && !event_pending(&events)) {
+        TRACE_BEGIN(TRACE_SLEEP);
+        power_sleep(!tone_busy() && display_idle());
+        TRACE_END(TRACE_SLEEP);
     }
+    restore_interrupts(irq);
 }
 
-bool minute_timer_callback(struct repeating_timer *t) {
-    // Se não houver mais ciclos, o programa volta ao menu inicial
-    if (!cycles_remaining) {
-        active = false;
-        return false;
+// Comandos de um caractere recebidos pelo stdio (USB): 'p' e 'r' do perfil, 't' do trace.
+void console_poll(void) {
+#if POMODORO_PROFILE || POMODORO_TRACE
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        profile_command(c);
+        trace_command(c);
     }
-    
-    // Verifica se está em um intervalo
-    if (break_minutes) {
-        break_minutes -= 1;
+#endif
+}
+
+// Roda na interrupção do alarme do tick: só publica o número do tick; a roda anda no laço principal.
+bool session_tick_callback(uint32_t tick, void *user_data) {
+    event_post(&events, EVENT_TICK, 0, tick);
+    return true;
+}
 
-        // Se acabou o intervalo, reseta o tempo de trabalho e ativa a flag de emitir som
-        if (!break_minutes) {
-            work_minutes = 0;
+// Leva a roda até o tick publicado. O evento traz só os 16 bits baixos do contador, suficientes
+// para recuperar o valor completo; se um evento se perder, o seguinte cobre os ticks que faltaram.
+void timer_tick(uint16_t tick) {
+    session_clock += (uint16_t) (tick - (uint16_t) session_clock);
+    sessions_advance(session_clock);
 
-            sound = true;
+    // Sem entradas, o painel escurece e depois apaga; apagado, o joystick não é amostrado e só o botão acorda
+    if (power_tick()) {
+        input_set_joystick(power_level() != POWER_BLANK);
+        state_changed = true;
+    }
 
-            // Contabiliza um ciclo e caso seja o último, reseta o programa.
-            if (!--cycles_remaining) {
-                active = false;
-                return false;
-            }
+    if (screen == UI_RESUME) {
+        if (session_clock >= RESUME_TIMEOUT_S)
+            boot_resume();
+        else
+            state_changed = true;
+    }
+    if (sessions_active() && !(session_clock % CHECKPOINT_PERIOD_S))
+        checkpoint_due = true;
+
+    // A sessão exibida conta segundos
+    if (screen == UI_TIMER && shown && !shown->paused)
+        state_changed = true;
+}
+
+// Chamada pela roda no fim de cada fase de qualquer sessão. Quando uma sessão termina, a página
+// exibida continua na mesma sessão; se era ela que terminou, passa à seguinte (ou à página "Nova sessão").
+// Sem sessões, volta ao menu.
+void timer_phase_end(session_t *session, uint8_t phase) {
+    TRACE_INSTANT(TRACE_PHASE_END, phase);
+    stats_phase_end(session, phase);
+    phase_ends++;
+    state_changed = true;
+    if (!session->used) {
+        history_log(session);
+        checkpoint_due = true;
+        if (!sessions_active()) {
+            if (screen == UI_TIMER)
+                menu_open();
+        } else if (!shown || session < shown) {
+            page_show(page - 1);
+        } else {
+            page_show(page);
         }
-        return true;
     }
+    panel_wake();
 
-    work_minutes += 1;
+    PROFILE_BEGIN(PROFILE_SOUND);
+    timer_sound();
+    PROFILE_END(PROFILE_SOUND);
+}
 
-    // Se passou o tempo de um ciclo, ativa o intervalo e a flag de emitir som
-    if (work_minutes == work_time[ind_work]) {
-        break_minutes = break_time[ind_break];
-        sound = true;
+// Entrada do usuário ou fim de fase: o painel volta ao contraste normal. Retorna true se ele estava
+// apagado; nesse caso a entrada só acende a tela e não é tratada.
+bool panel_wake(void) {
+    power_level_t before = power_level();
+    bool was_blank = power_activity();
+    if (power_level() != before) {
+        input_set_joystick(true);
+        state_changed = true;
     }
+    return was_blank;
+}
 
-    // Retorna true para manter o temporizador repetindo. Se retornar false, o temporizador para.
-    return true;
+// Registra a sessão concluída. A página do histórico vai para a flash quando enche ou vence o prazo dela.
+void history_log(const session_t *session) {
+    history_record_t record = {
+        .start_s = session->started,
+        .boot = history_boot(),
+        .preset_cycles = session->preset[0],
+        .preset_work = session->preset[1],
+        .preset_break = session->preset[2],
+        .cycles_done = session->cycles - session->cycles_remaining,
+        .interruptions = session->pauses,
+    };
+    history_append(&record);
 }
 
-void nota(uint32_t frequencia, uint32_t tempo_ms) {
-    uint32_t delay = 1000000 / (frequencia * 2);  // Calcula o tempo de atraso em microssegundos para gerar a onda quadrada
-    uint32_t ciclo = frequencia * tempo_ms / 1000;  // Calcula o número de ciclos necessários para a duração desejada
+// Lê o checkpoint mais recente: a configuração volta a ser a pré-seleção do menu e, se havia sessões
+// em andamento, a primeira tela oferece a retomada. O tempo em que a placa ficou desligada não conta.
+void boot_restore(void) {
+    if (checkpoint_init(&boot_checkpoint)) {
+        ind_cycles = boot_checkpoint.preset[0] < count_of(cycles) ? boot_checkpoint.preset[0] : 0;
+        ind_work = boot_checkpoint.preset[1] < count_of(work_time) ? boot_checkpoint.preset[1] : 0;
+        ind_break = boot_checkpoint.preset[2] < count_of(break_time) ? boot_checkpoint.preset[2] : 0;
+    }
+
+    if (boot_checkpoint.count)
+        screen = UI_RESUME;
+    else
+        menu_open();
+    state_changed = true;
+}
 
-    // Loop para gerar a onda quadrada no buzzer
-    for (uint32_t i = 0; i < ciclo; i++) {
-        gpio_put(A_BUZZER, 1);
-        gpio_put(B_BUZZER, 1);
-        sleep_us(delay);
-        gpio_put(A_BUZZER, 0);
-        gpio_put(B_BUZZER, 0);
-        sleep_us(delay); // Espera novamente pelo tempo de atraso para completar o ciclo
+// Recria as sessões salvas, cada uma com o saldo que tinha a fase no último checkpoint.
+void boot_resume(void) {
+    for (uint i = 0; i < boot_checkpoint.count; ++i)
+        session_restore(&boot_checkpoint.sessions[i]);
+    boot_checkpoint.count = 0;
+
+    if (sessions_active()) {
+        screen = UI_TIMER;
+        page_show(0);
+    } else {
+        menu_open();
     }
 }
 
-// Efeito sonoro de 3 beeps
+// Abandona as sessões salvas; o próximo checkpoint fica sem sessões.
+void boot_discard(void) {
+    for (uint i = 0; i < boot_checkpoint.count; ++i)
+        stats_session_aborted(&boot_checkpoint.sessions[i]);
+    boot_checkpoint.count = 0;
+    menu_open();
+    checkpoint_due = true;
+}
+
+void checkpoint_write(void) {
+    static checkpoint_t checkpoint;
+    TRACE_BEGIN(TRACE_CHECKPOINT);
+    checkpoint.preset[0] = ind_cycles;
+    checkpoint.preset[1] = ind_work;
+    checkpoint.preset[2] = ind_break;
+    checkpoint.count = sessions_save(checkpoint.sessions, count_of(checkpoint.sessions));
+    checkpoint_save(&checkpoint);
+    TRACE_END(TRACE_CHECKPOINT);
+}
+
+// Efeito sonoro de 3 beeps, tocado pelo PWM em segundo plano
 void timer_sound() {
-    nota(132, 200);
-    sleep_ms(100);
-    nota(165, 200);
-    sleep_ms(100);
-    nota(247, 200);
-}
\ No newline at end of file
+    static const tone_note_t beeps[] = {
+        { 132, 200 }, { 0, 100 },
+        { 165, 200 }, { 0, 100 },
+        { 247, 200 },
+    };
+    power_clock_full(); // As notas são calculadas pelo clk_sys
+    tone_play(beeps, count_of(beeps));
+}
@@ -0,0 +1,257 @@
+#!/usr/bin/env python3
+"""Converte fontes BDF/PSF em tabelas C constantes para o SSD1306.
+
+Cada fonte vira um bitmap em ordem de página (para cada página de 8 linhas, as colunas do glifo da
+esquerda para a direita, bit 0 na linha de cima, o mesmo formato do buffer do display) e um índice
+com deslocamento, largura desenhada e avanço de cada código. O desenho copia os bytes direto para o
+buffer, sem decodificar nada em tempo de execução.
+
+Uso:
+    fontgen.py -o fonts.c nome=arquivo.bdf[:primeiro-último] ...
+
+O intervalo padrão é 32-126. Códigos sem glifo no intervalo ficam vazios, com o avanço do espaço.
+A ocupação de cada fonte é impressa durante a compilação.
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+GLYPH_ENTRY_BYTES = 4   # sizeof(font_glyph_t)
+FONT_STRUCT_BYTES = 12  # sizeof(font_t) no RP2040
+
+
+class Glyph:
+    def __init__(self, advance, rows):
+        self.advance = advance
+        self.rows = rows    # Linhas da célula, cada uma uma lista de 0/1 desde a coluna 0
+
+
+class Font:
+    def __init__(self, height):
+        self.height = height
+        self.glyphs = {}
+
+
+def parse_bdf(path):
+    ascent = descent = None
+    bbox = None
+    font = None
+    with open(path, encoding='latin-1') as f:
+        lines = iter(f.read().splitlines())
+
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        key = words[0]
+        if key == 'FONTBOUNDINGBOX':
+            bbox = [int(v) for v in words[1:5]]
+        elif key == 'FONT_ASCENT':
+            ascent = int(words[1])
+        elif key == 'FONT_DESCENT':
+            descent = int(words[1])
+        elif key == 'STARTCHAR':
+            if font is None:
+                if ascent is None:
+                    ascent = bbox[1] + bbox[3]
+                if descent is None:
+                    descent = -bbox[3]
+                font = Font(ascent + descent)
+            code, advance, box, bitmap = None, None, None, []
+            for line in lines:
+                words = line.split()
+                if not words:
+                    continue
+                if words[0] == 'ENCODING':
+                    code = int(words[-1])
+                elif words[0] == 'DWIDTH':
+                    advance = int(words[1])
+                elif words[0] == 'BBX':
+                    box = [int(v) for v in words[1:5]]
+                elif words[0] == 'BITMAP':
+                    for line in lines:
+                        if line.strip() == 'ENDCHAR':
+                            break
+                        row = line.strip()
+                        bitmap.append((int(row, 16), len(row) * 4))
+                    break
+            if code is None or code < 0:
+                continue
+            w, h, xoff, yoff = box
+            top = ascent - (yoff + h)
+            rows = [[0] * max(w + xoff, 0) for _ in range(font.height)]
+            for r, (value, bits) in enumerate(bitmap[:h]):
+                y = top + r
+                if not 0 <= y < font.height:
+                    continue
+                for i in range(w):
+                    if value >> (bits - 1 - i) & 1 and xoff + i >= 0:
+                        rows[y][xoff + i] = 1
+            font.glyphs[code] = Glyph(advance if advance is not None else w, rows)
+
+    if font is None:
+        sys.exit(f'{path}: nenhum glifo')
+    return font
+
+
+def parse_psf(path):
+    with open(path, 'rb') as f:
+        data = f.read()
+
+    unicode_table = None
+    if data[:2] == b'\x36\x04':
+        mode, charsize = data[2], data[3]
+        count = 512 if mode & 0x01 else 256
+        width, height, offset = 8, charsize, 4
+        if mode & 0x02:
+            unicode_table = ('psf1', offset + count * charsize)
+    elif data[:4] == b'\x72\xb5\x4a\x86':
+        _, offset, flags, count, charsize, height, width = struct.unpack_from('<7I', data, 4)
+        if flags & 0x01:
+            unicode_table = ('psf2', offset + count * charsize)
+    else:
+        sys.exit(f'{path}: não é PSF1 nem PSF2')
+
+    # Sem tabela Unicode, o índice do glifo é o código
+    codes = {i: [i] for i in range(count)}
+    if unicode_table:
+        kind, pos = unicode_table
+        codes = {}
+        for index in range(count):
+            codes[index] = []
+            if kind == 'psf1':
+                while pos + 1 < len(data):
+                    value = struct.unpack_from('<H', data, pos)[0]
+                    pos += 2
+                    if value == 0xFFFF:
+                        break
+                    if value != 0xFFFE:
+                        codes[index].append(value)
+            else:
+                end = data.index(b'\xff', pos)
+                # Sequências depois de 0xFE são combinações; só os códigos isolados interessam
+                for ch in data[pos:end].split(b'\xfe')[0].decode('utf-8', 'replace'):
+                    codes[index].append(ord(ch))
+                pos = end + 1
+
+    font = Font(height)
+    stride = (width + 7) // 8
+    for index in range(count):
+        base = offset + index * charsize
+        rows = []
+        for y in range(height):
+            row = data[base + y * stride:base + (y + 1) * stride]
+            value = int.from_bytes(row, 'big')
+            rows.append([value >> (stride * 8 - 1 - x) & 1 for x in range(width)])
+        for code in codes[index]:
+            font.glyphs.setdefault(code, Glyph(width, rows))
+    return font
+
+
+def pack(font, first, last):
+    pages = (font.height + 7) // 8
+    default = font.glyphs.get(first)
+    default_advance = default.advance if default else 0
+
+    bitmap = []
+    entries = []
+    for code in range(first, last + 1):
+        glyph = font.glyphs.get(code)
+        if glyph is None:
+            entries.append((0, 0, default_advance, code))
+            continue
+        # Colunas em branco à direita não são guardadas: o desenho completa com zeros até o avanço
+        width = 0
+        for row in glyph.rows:
+            for x, bit in enumerate(row):
+                if bit:
+                    width = max(width, x + 1)
+        if len(bitmap) + width * pages > 0xFFFF:
+            sys.exit('bitmap maior que 64 KiB')
+        offset = len(bitmap)
+        for page in range(pages):
+            for x in range(width):
+                byte = 0
+                for bit in range(8):
+                    y = page * 8 + bit
+                    if y < font.height and x < len(glyph.rows[y]) and glyph.rows[y][x]:
+                        byte |= 1 << bit
+                bitmap.append(byte)
+        entries.append((offset if width else 0, width, min(glyph.advance, 255), code))
+    return pages, bitmap, entries
+
+
+def char_comment(code):
+    if code == 0x20:
+        return 'espaço'
+    if code == 0x5C:
+        return 'barra invertida'
+    if 32 < code < 127:
+        return repr(chr(code))
+    return f'U+{code:04X}'
+
+
+def emit(out, name, source, first, last, pages, bitmap, entries):
+    out.append(f'// {name}: {os.path.basename(source)}, códigos {first}-{last}, {pages * 8} linhas')
+    out.append(f'static const uint8_t {name}_bitmap[] = {{')
+    for i in range(0, len(bitmap), 16):
+        out.append('  ' + ', '.join(f'0x{b:02x}' for b in bitmap[i:i + 16]) + ',')
+    if not bitmap:
+        out.append('  0x00,')
+    out.append('};')
+    out.append('')
+    out.append(f'static const font_glyph_t {name}_glyphs[] = {{')
+    for offset, width, advance, code in entries:
+        out.append(f'  {{ {offset:5d}, {width:3d}, {advance:3d} }}, // {char_comment(code)}')
+    out.append('};')
+    out.append('')
+    out.append(f'const font_t {name} = {{')
+    out.append(f'  .bitmap = {name}_bitmap, .glyphs = {name}_glyphs,')
+    out.append(f'  .first = {first}, .last = {last}, .pages = {pages},')
+    out.append('};')
+    out.append('')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-o', '--output', required=True)
+    parser.add_argument('fonts', nargs='+', metavar='nome=arquivo[:primeiro-último]')
+    args = parser.parse_args()
+
+    out = [
+        '// Gerado por tools/fontgen.py. Não edite: altere as fontes em fonts/ e recompile.',
+        '',
+        '#include "inc/font.h"',
+        '',
+    ]
+    report = []
+    total = 0
+    for spec in args.fonts:
+        name, _, source = spec.partition('=')
+        first, last = 32, 126
+        if ':' in os.path.basename(source):
+            source, _, span = source.rpartition(':')
+            first, last = (int(v, 0) for v in span.split('-'))
+
+        font = parse_psf(source) if source.endswith('.psf') or source.endswith('.psfu') else parse_bdf(source)
+        pages, bitmap, entries = pack(font, first, last)
+        emit(out, name, source, first, last, pages, bitmap, entries)
+
+        present = sum(1 for e in entries if e[1])
+        flash = len(bitmap) + len(entries) * GLYPH_ENTRY_BYTES + FONT_STRUCT_BYTES
+        total += flash
+        report.append(f'fontgen: {name}: {present} glifos desenhados, {pages * 8} linhas, '
+                      f'bitmap {len(bitmap)} B + índice {len(entries) * GLYPH_ENTRY_BYTES} B '
+                      f'= {flash} B de flash, 0 B de RAM')
+
+    with open(args.output, 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out))
+    for line in report:
+        print(line)
+    print(f'fontgen: total {total} B de flash, 0 B de RAM')
+
+
+if __name__ == '__main__':
+    main()
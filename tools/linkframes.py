@@ -0,0 +1,65 @@
+"""Leitura dos quadros binários que a placa envia pela USB CDC (inc/link.h).
+
+Cada quadro é 0xA5, tipo, comprimento, carga e CRC-8 (polinômio 0x07) do tipo, do comprimento e da carga.
+Bytes fora de um quadro válido, como o texto do relatório do perfil, são ignorados. Usado por
+statsdecode.py e tracedump.py.
+"""
+
+import os
+import termios
+import tty
+
+LINK_SYNC = 0xA5
+LINK_STATS = 1
+LINK_TRACE = 2
+LINK_TRACE_NAME = 3
+
+
+def crc8(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def frames(chunks):
+    """Gera (tipo, carga) de cada quadro válido em uma sequência de blocos de bytes."""
+    buf = bytearray()
+    for chunk in chunks:
+        buf += chunk
+        start = 0
+        while True:
+            start = buf.find(LINK_SYNC, start)
+            if start < 0:
+                buf.clear()
+                break
+            if len(buf) - start < 4:
+                del buf[:start]
+                break
+            length = buf[start + 2]
+            end = start + 3 + length + 1
+            if len(buf) < end:
+                del buf[:start]
+                break
+            if crc8(buf[start + 1:end - 1]) == buf[end - 1]:
+                yield buf[start + 1], bytes(buf[start + 3:end - 1])
+                start = end
+            else:
+                start += 1
+
+
+def read_chunks(path):
+    """Gera os blocos lidos de uma porta serial (em modo cru) ou de um arquivo."""
+    fd = os.open(path, os.O_RDONLY | getattr(os, 'O_NOCTTY', 0))
+    try:
+        if os.isatty(fd):
+            tty.setraw(fd, termios.TCSANOW)   # Sem tradução de \r\n nem eco
+        while True:
+            chunk = os.read(fd, 4096)
+            if not chunk:
+                return
+            yield chunk
+    finally:
+        os.close(fd)
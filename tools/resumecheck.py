@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Confere no simulador que a contagem regressiva da tela de retomada anda.
+
+Uma primeira execução termina no meio de uma sessão e deixa o checkpoint numa imagem da flash; a segunda parte
+dessa imagem, abre na tela de retomada e imprime a tela (ação S do roteiro) em dois instantes antes do
+RESUME_TIMEOUT_S. As duas telas precisam ser diferentes: o número "Auto em Ns" muda a cada segundo.
+
+Uso:
+    resumecheck.py build-host/host/pomodoro_host
+    resumecheck.py build-host/host/pomodoro_host_dual
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+SESSION_END_MS = 10 * 60 * 1000    # Termina com as sessões do roteiro padrão em andamento
+SNAPSHOTS_MS = (1500, 5500)
+
+
+def run(host, flash, script=None, end_ms=None):
+    env = dict(os.environ, POMODORO_SIM_FLASH=flash)
+    env.pop('POMODORO_SIM_SCRIPT', None)
+    if script is not None:
+        env['POMODORO_SIM_SCRIPT'] = script
+    if end_ms is not None:
+        env['POMODORO_SIM_END_MS'] = str(end_ms)
+    return subprocess.run([host], env=env, check=True, capture_output=True, text=True).stdout
+
+
+def screens(output):
+    """Separa as telas impressas pela ação S. A tela final do simulador vem logo depois da última, sem
+    cabeçalho, então cada tela tem a altura da primeira."""
+    lines = output.splitlines()
+    starts = [i + 1 for i, line in enumerate(lines) if line.startswith('[sim] tela em')]
+    height = starts[1] - starts[0] - 1
+    return ['\n'.join(lines[i:i + height]) for i in starts]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('host', help='executável do simulador (pomodoro_host ou pomodoro_host_dual)')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        flash = os.path.join(tmp, 'flash.bin')
+        run(args.host, flash, end_ms=SESSION_END_MS)
+        script = ','.join(f'{ms}:S' for ms in SNAPSHOTS_MS)
+        first, last = screens(run(args.host, flash, script, SNAPSHOTS_MS[-1] + 500))[:2]
+
+    if first == last:
+        print(f'resumecheck: a tela de retomada ficou parada entre {SNAPSHOTS_MS[0]} e {SNAPSHOTS_MS[-1]} ms')
+        print(last)
+        return 1
+    print(f'resumecheck: a contagem da tela de retomada mudou entre {SNAPSHOTS_MS[0]} e {SNAPSHOTS_MS[-1]} ms')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
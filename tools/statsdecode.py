@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Decodifica os quadros binários de estatísticas que a placa envia pela USB CDC.
+
+Cada quadro é 0xA5, tipo, comprimento, carga e CRC-8 (polinômio 0x07) do tipo, do comprimento e da carga
+(inc/link.h). Bytes fora de um quadro válido, como o texto do relatório do perfil, são ignorados. Cada
+registro de estatísticas (stats_t, inc/stats.h) vira uma linha JSON na saída padrão.
+
+Uso:
+    statsdecode.py /dev/ttyACM0              # porta serial da placa
+    statsdecode.py captura.bin               # arquivo, por exemplo o POMODORO_SIM_SERIAL do simulador
+
+Com --last imprime só o último registro de cada boot.
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+from linkframes import LINK_STATS, frames, read_chunks
+
+STATS_PRESETS = 6
+STATS_HEADER = struct.Struct('<IIHBBIIIII')
+STATS_STREAK = struct.Struct('<HH')
+STATS_SIZE = STATS_HEADER.size + STATS_PRESETS * STATS_STREAK.size
+WORK_MINUTES = (20, 25, 30, 40, 50, 60)   # work_time[] em pomodoro.c
+
+
+def decode_stats(payload):
+    if len(payload) != STATS_SIZE:
+        return None
+    (seq, uptime_s, boot, version, active, focus_s, cycles_completed, cycles_aborted,
+     sessions_completed, sessions_aborted) = STATS_HEADER.unpack_from(payload)
+    streaks = {}
+    for i in range(STATS_PRESETS):
+        current, best = STATS_STREAK.unpack_from(payload, STATS_HEADER.size + i * STATS_STREAK.size)
+        if current or best:
+            streaks[f'{WORK_MINUTES[i]}min'] = {'current': current, 'best': best}
+    return {
+        'boot': boot, 'seq': seq, 'version': version, 'uptime_s': uptime_s, 'active': active,
+        'focus_min': round(focus_s / 60, 1),
+        'cycles_completed': cycles_completed, 'cycles_aborted': cycles_aborted,
+        'sessions_completed': sessions_completed, 'sessions_aborted': sessions_aborted,
+        'streaks': streaks,
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('path', help='porta serial ou arquivo com o fluxo')
+    parser.add_argument('--last', action='store_true', help='só o último registro de cada boot')
+    args = parser.parse_args()
+
+    last = {}
+    lost = 0
+    expected = {}
+    try:
+        for kind, payload in frames(read_chunks(args.path)):
+            if kind != LINK_STATS:
+                continue
+            record = decode_stats(payload)
+            if record is None:
+                continue
+            boot = record['boot']
+            if boot in expected and record['seq'] > expected[boot]:
+                lost += record['seq'] - expected[boot]
+            expected[boot] = record['seq'] + 1
+            if args.last:
+                last[boot] = record
+            else:
+                print(json.dumps(record), flush=True)
+    except KeyboardInterrupt:
+        pass
+
+    for record in last.values():
+        print(json.dumps(record))
+    if lost:
+        print(f'statsdecode: {lost} registros perdidos', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
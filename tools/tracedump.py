@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+"""Converte o trace de eventos que a placa envia pela USB CDC em JSON de trace do Chrome.
+
+O firmware, compilado com -DPOMODORO_TRACE=ON, envia o trace ao receber 't' (ação T no roteiro do
+simulador): primeiro um quadro LINK_TRACE_NAME por evento, com o identificador, a faixa e o nome, depois
+os anéis dos dois núcleos em quadros LINK_TRACE (trace_chunk_t, inc/trace.h). O JSON sai na saída padrão
+e abre em https://ui.perfetto.dev ou em chrome://tracing, com uma linha do tempo por núcleo e faixa.
+
+Uso:
+    tracedump.py /dev/ttyACM0 > trace.json   # porta serial da placa; Ctrl-C encerra a leitura
+    tracedump.py captura.bin > trace.json    # arquivo, por exemplo o POMODORO_SIM_SERIAL do simulador
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+from linkframes import LINK_TRACE, LINK_TRACE_NAME, frames, read_chunks
+
+CHUNK_HEADER = struct.Struct('<IBBH')     # lost, core, count, chunk
+EVENT = struct.Struct('<IBcH')            # ts_us, id, ph, arg
+TRACKS = ('loop', 'irq', 'i2c', 'sound')  # trace_track_t
+CORE_LOOP = ('main', 'display')
+
+
+class Core:
+    """Estende o time_us_32 de um núcleo para 64 bits, contando as voltas do contador."""
+
+    def __init__(self):
+        self.last = None
+        self.high = 0
+
+    def unwrap(self, ts):
+        if self.last is not None and ts < self.last and self.last - ts > 1 << 31:
+            self.high += 1 << 32
+        self.last = ts
+        return self.high + ts
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('path', help='porta serial ou arquivo com o fluxo')
+    args = parser.parse_args()
+
+    names = {}
+    cores = {}
+    events = []
+    threads = set()
+    lost = 0
+    dumps = 0
+    try:
+        for kind, payload in frames(read_chunks(args.path)):
+            if kind == LINK_TRACE_NAME and len(payload) >= 2:
+                names[payload[0]] = (payload[1], payload[2:].decode('ascii', 'replace'))
+            elif kind == LINK_TRACE and len(payload) >= CHUNK_HEADER.size:
+                chunk_lost, core, count, chunk = CHUNK_HEADER.unpack_from(payload)
+                if len(payload) != CHUNK_HEADER.size + count * EVENT.size:
+                    continue
+                if chunk == 0:
+                    dumps += 1
+                lost += chunk_lost
+                clock = cores.setdefault(core, Core())
+                for i in range(count):
+                    ts, ident, ph, arg = EVENT.unpack_from(payload, CHUNK_HEADER.size + i * EVENT.size)
+                    track, name = names.get(ident, (0, f'id{ident}'))
+                    tid = core * len(TRACKS) + track
+                    threads.add((core, track))
+                    event = {'name': name, 'ph': ph.decode('ascii'), 'ts': clock.unwrap(ts), 'pid': 0, 'tid': tid}
+                    if event['ph'] == 'i':
+                        event['s'] = 't'
+                    if arg:
+                        event['args'] = {'arg': arg}
+                    events.append(event)
+    except KeyboardInterrupt:
+        pass
+
+    meta = [{'name': 'process_name', 'ph': 'M', 'pid': 0, 'args': {'name': 'pomodoro'}}]
+    for core, track in sorted(threads):
+        label = CORE_LOOP[core] if track == 0 and core < len(CORE_LOOP) else TRACKS[track]
+        meta.append({'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': core * len(TRACKS) + track,
+                     'args': {'name': f'core{core} {label}'}})
+
+    json.dump({'traceEvents': meta + events, 'displayTimeUnit': 'ms'}, sys.stdout)
+    sys.stdout.write('\n')
+    print(f'tracedump: {len(events)} eventos em {dumps} envios', file=sys.stderr)
+    if lost:
+        print(f'tracedump: {lost} eventos sobrescritos antes do envio', file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()